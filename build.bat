@@ -12,8 +12,11 @@ call "C:\Program Files\Microsoft Visual Studio\2022\Community\VC\Auxiliary\Build
 :: Ensure build directory exists
 if not exist "build" mkdir build
 
-:: Source files
-set SOURCES=src\main.cpp src\attacks.cpp src\board.cpp src\movegen.cpp src\eval.cpp src\search.cpp src\book.cpp src\see.cpp
+:: Source files (engine library + front ends)
+set LIB_SOURCES=src\attacks.cpp src\board.cpp src\movegen.cpp src\eval.cpp src\search.cpp src\book.cpp src\see.cpp src\material.cpp src\endgame.cpp src\nnue.cpp src\packed.cpp src\attackinfo.cpp src\evalbatch.cpp src\bitbase.cpp src\tbprobe.cpp src\tt.cpp
+set SOURCES=src\main.cpp %LIB_SOURCES%
+
+:: Add /arch:AVX2 to the flags below to enable the AVX2 NNUE kernels
 
 echo [*] Compiling Nova with MSVC (C++20, /O2)...
 echo.
@@ -27,7 +30,43 @@ if %ERRORLEVEL% neq 0 (
 )
 
 echo.
-echo [+] Build successful: build\nova.exe
+echo [*] Compiling NNUE trainer...
+echo.
+
+cl /std:c++20 /O2 /EHsc /W4 /Fe:build\train.exe /I src tools\train.cpp %LIB_SOURCES%
+
+if %ERRORLEVEL% neq 0 (
+    echo.
+    echo [!] BUILD FAILED
+    exit /b 1
+)
+
+echo.
+echo [*] Compiling Texel tuner...
+echo.
+
+cl /std:c++20 /O2 /EHsc /W4 /Fe:build\tune.exe /I src tools\tune.cpp %LIB_SOURCES%
+
+if %ERRORLEVEL% neq 0 (
+    echo.
+    echo [!] BUILD FAILED
+    exit /b 1
+)
+
+echo.
+echo [*] Compiling tablebase generator...
+echo.
+
+cl /std:c++20 /O2 /EHsc /W4 /Fe:build\tbgen.exe /I src tools\tbgen.cpp %LIB_SOURCES%
+
+if %ERRORLEVEL% neq 0 (
+    echo.
+    echo [!] BUILD FAILED
+    exit /b 1
+)
+
+echo.
+echo [+] Build successful: build\nova.exe, build\train.exe, build\tune.exe, build\tbgen.exe
 echo.
 
 :: Cleanup obj files from root
@@ -0,0 +1,68 @@
+#include "attackinfo.hpp"
+
+namespace chess {
+
+AttackInfo::AttackInfo(const Board& board) {
+    Bitboard occ = board.occupied();
+
+    for (int c = 0; c < 2; ++c) {
+        for (int pt = 0; pt < PIECE_TYPE_NB; ++pt) attacked[c][pt] = EMPTY_BB;
+        attacked2[c] = EMPTY_BB;
+        king_attacks[c] = 0;
+        mobility[c] = 0;
+        pinned[c] = EMPTY_BB;
+        Square ksq = board.king_sq(Color(c));
+        king_zone[c] = KingAttacks[ksq] | square_bb(ksq);
+    }
+
+    for (int c = 0; c < 2; ++c) {
+        Color us = Color(c), them = ~us;
+
+        Bitboard bb = board.pieces(us, PAWN);
+        while (bb) add(us, PAWN, PawnAttacks[us][pop_lsb(bb)]);
+
+        for (int pt = KNIGHT; pt <= QUEEN; ++pt) {
+            bb = board.pieces(us, PieceType(pt));
+            while (bb) {
+                Bitboard a = get_attacks(PieceType(pt), pop_lsb(bb), occ);
+                add(us, PieceType(pt), a);
+                mobility[us] += popcount(a & ~board.pieces(us));
+                king_attacks[them] += popcount(a & king_zone[them]);
+            }
+        }
+
+        add(us, KING, KingAttacks[board.king_sq(us)]);
+
+        // Pins: enemy sliders aligned with our king behind exactly one piece
+        Square ksq = board.king_sq(us);
+        Bitboard snipers = (get_rook_attacks(ksq, EMPTY_BB) & (board.pieces(them, ROOK) | board.pieces(them, QUEEN)))
+                         | (get_bishop_attacks(ksq, EMPTY_BB) & (board.pieces(them, BISHOP) | board.pieces(them, QUEEN)));
+        while (snipers) {
+            Bitboard between = BetweenBB[ksq][pop_lsb(snipers)] & occ;
+            if (between && !more_than_one(between) && (between & board.pieces(us)))
+                pinned[us] |= between;
+        }
+    }
+
+    Color us = board.side_to_move(), them = ~us;
+    Square ksq = board.king_sq(us);
+    checkers = board.attackers_to(ksq, occ) & board.pieces(them);
+
+    // A slider's attack continues through the king, so the king cannot
+    // step back along the checking line
+    king_unsafe = attacks(them);
+    Bitboard sliders = checkers & ~(board.pieces(PAWN) | board.pieces(KNIGHT));
+    while (sliders) {
+        Square s = pop_lsb(sliders);
+        king_unsafe |= LineBB[s][ksq] & ~square_bb(s);
+    }
+
+    threat_pawn = attacks(them, PAWN);
+    threat_minor = threat_pawn | attacks(them, KNIGHT) | attacks(them, BISHOP);
+    threat_rook = threat_minor | attacks(them, ROOK);
+    threatened = (board.pieces(us, QUEEN) & threat_rook)
+               | (board.pieces(us, ROOK) & threat_minor)
+               | ((board.pieces(us, KNIGHT) | board.pieces(us, BISHOP)) & threat_pawn);
+}
+
+} // namespace chess
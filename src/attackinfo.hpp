@@ -0,0 +1,50 @@
+#pragma once
+
+#include "board.hpp"
+
+namespace chess {
+
+// ============================================================
+// Attack information for one position, computed once per node and
+// shared by evaluation, castling and legality checks.
+// ============================================================
+struct AttackInfo {
+    // Squares attacked by colour c with pieces of type pt;
+    // attacked[c][NO_PIECE_TYPE] is the union over all pieces
+    Bitboard attacked[COLOR_NB][PIECE_TYPE_NB];
+    Bitboard attacked2[COLOR_NB];     // Attacked at least twice by c
+    Bitboard king_zone[COLOR_NB];     // c's king square and its neighbours
+    int      king_attacks[COLOR_NB];  // Enemy knight..queen attacks on c's king zone
+    int      mobility[COLOR_NB];      // Knight..queen attacks not on own pieces
+    Bitboard pinned[COLOR_NB];        // c's pieces pinned to c's king
+
+    // Side to move only
+    Bitboard checkers;                // Enemy pieces giving check
+    Bitboard king_unsafe;             // Squares the king may not step to
+    Bitboard threat_pawn;             // Attacked by enemy pawns
+    Bitboard threat_minor;            // ... by pawns, knights or bishops
+    Bitboard threat_rook;             // ... by pawns, minors or rooks
+    Bitboard threatened;              // Our pieces attacked by a cheaper piece
+
+    explicit AttackInfo(const Board& board);
+
+    Bitboard attacks(Color c) const { return attacked[c][NO_PIECE_TYPE]; }
+    Bitboard attacks(Color c, PieceType pt) const { return attacked[c][pt]; }
+
+    // Squares where the side to move's piece of type pt could be taken
+    // by a cheaper enemy piece
+    Bitboard danger(PieceType pt) const {
+        return pt == QUEEN ? threat_rook
+             : pt == ROOK  ? threat_minor
+             : pt == KNIGHT || pt == BISHOP ? threat_pawn : EMPTY_BB;
+    }
+
+private:
+    void add(Color c, PieceType pt, Bitboard b) {
+        attacked2[c] |= attacked[c][NO_PIECE_TYPE] & b;
+        attacked[c][NO_PIECE_TYPE] |= b;
+        attacked[c][pt] |= b;
+    }
+};
+
+} // namespace chess
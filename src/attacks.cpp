@@ -5,6 +5,8 @@ namespace chess {
 Bitboard PawnAttacks[COLOR_NB][SQUARE_NB];
 Bitboard KnightAttacks[SQUARE_NB];
 Bitboard KingAttacks[SQUARE_NB];
+Bitboard BetweenBB[SQUARE_NB][SQUARE_NB];
+Bitboard LineBB[SQUARE_NB][SQUARE_NB];
 
 // Ray directions for sliding pieces: {file_delta, rank_delta}
 static constexpr int BishopDirs[4][2] = {{1,1},{1,-1},{-1,1},{-1,-1}};
@@ -79,6 +81,24 @@ void init_attacks() {
                 KingAttacks[sq] |= square_bb(make_square(File(nf), Rank(nr)));
         }
     }
+
+    // Lines and segments between aligned squares
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            BetweenBB[a][b] = LineBB[a][b] = EMPTY_BB;
+            if (a == b) continue;
+            Square sa = Square(a), sb = Square(b);
+            if (get_bishop_attacks(sa, EMPTY_BB) & square_bb(sb)) {
+                LineBB[a][b] = (get_bishop_attacks(sa, EMPTY_BB) & get_bishop_attacks(sb, EMPTY_BB))
+                             | square_bb(sa) | square_bb(sb);
+                BetweenBB[a][b] = get_bishop_attacks(sa, square_bb(sb)) & get_bishop_attacks(sb, square_bb(sa));
+            } else if (get_rook_attacks(sa, EMPTY_BB) & square_bb(sb)) {
+                LineBB[a][b] = (get_rook_attacks(sa, EMPTY_BB) & get_rook_attacks(sb, EMPTY_BB))
+                             | square_bb(sa) | square_bb(sb);
+                BetweenBB[a][b] = get_rook_attacks(sa, square_bb(sb)) & get_rook_attacks(sb, square_bb(sa));
+            }
+        }
+    }
 }
 
-} // namespace chess
+} // namespace chess
\ No newline at end of file
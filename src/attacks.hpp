@@ -9,6 +9,11 @@ extern Bitboard PawnAttacks[COLOR_NB][SQUARE_NB];
 extern Bitboard KnightAttacks[SQUARE_NB];
 extern Bitboard KingAttacks[SQUARE_NB];
 
+// Squares strictly between two aligned squares, and the full line through
+// them (both include nothing if the squares are not on a common line)
+extern Bitboard BetweenBB[SQUARE_NB][SQUARE_NB];
+extern Bitboard LineBB[SQUARE_NB][SQUARE_NB];
+
 // Initialize all precomputed tables (call once at startup)
 void init_attacks();
 
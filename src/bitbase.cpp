@@ -0,0 +1,173 @@
+#include "bitbase.hpp"
+#include "attacks.hpp"
+#include <vector>
+
+namespace chess {
+
+// ============================================================
+// Indexing: [side to move][pawn slot][white king][black king]. The
+// pawn slot numbers the squares of files A-D, ranks 2-7, from 0 to 23.
+// ============================================================
+constexpr int KPK_PAWN_SLOTS = 24;
+constexpr int KPK_SIZE = COLOR_NB * KPK_PAWN_SLOTS * SQUARE_NB * SQUARE_NB;
+
+static uint64_t KPKBitbase[KPK_SIZE / 64];
+
+static int pawn_slot(Square psq) {
+    return (int(rank_of(psq)) - RANK_2) * 4 + int(file_of(psq));
+}
+
+static Square slot_square(int slot) {
+    return make_square(File(slot % 4), Rank(RANK_2 + slot / 4));
+}
+
+static int kpk_index(Color stm, Square psq, Square wksq, Square bksq) {
+    return ((int(stm) * KPK_PAWN_SLOTS + pawn_slot(psq)) * SQUARE_NB + int(wksq)) * SQUARE_NB + int(bksq);
+}
+
+// ============================================================
+// Generation by retrograde analysis
+//
+// Terminal positions are labelled first: White to move wins at once by
+// promoting to a piece Black can neither take nor be stalemated by, and
+// Black to move draws by taking the pawn or being stalemated (or loses
+// to mate). Wins are then propagated backwards through un-moves. A
+// White-to-move position is won as soon as one successor is, and a
+// Black-to-move position once all of its king moves lead to wins.
+// Everything never reached is a draw.
+// ============================================================
+namespace {
+
+enum KPKState : uint8_t { KPK_UNKNOWN, KPK_WIN, KPK_DRAW, KPK_ILLEGAL };
+
+bool is_legal(Color stm, Square wksq, Square bksq, Square psq) {
+    return distance(wksq, bksq) > 1 && wksq != psq && bksq != psq
+        && !(stm == WHITE && (PawnAttacks[WHITE][psq] & square_bb(bksq)));
+}
+
+// Promoting on 'promo' wins if, for a queen or a rook, the new piece
+// cannot be taken and Black is not left without a move
+bool promotion_wins(Square wksq, Square bksq, Square promo) {
+    if ((KingAttacks[bksq] & square_bb(promo)) && !(KingAttacks[wksq] & square_bb(promo)))
+        return false;
+
+    for (PieceType pt : {QUEEN, ROOK}) {
+        // Rays pass through Black's king: it cannot step back along them
+        Bitboard attacked = get_attacks(pt, promo, square_bb(wksq)) | KingAttacks[wksq];
+        bool check = attacked & square_bb(bksq);
+        if (check || (KingAttacks[bksq] & ~attacked))
+            return true;
+    }
+    return false;
+}
+
+struct KPKGenerator {
+    std::vector<uint8_t> state;
+    std::vector<uint8_t> escapes;   // Black to move: king moves not yet known to lose
+    std::vector<int>     won;       // Wins whose predecessors are still to be visited
+
+    void label(Color stm, Square psq, Square wksq, Square bksq);
+    void propagate(int idx);
+
+    void mark_win(int idx) {
+        state[idx] = KPK_WIN;
+        won.push_back(idx);
+    }
+
+    void run() {
+        state.assign(KPK_SIZE, KPK_UNKNOWN);
+        escapes.assign(KPK_SIZE, 0);
+
+        for (int stm = WHITE; stm <= BLACK; ++stm)
+            for (int slot = 0; slot < KPK_PAWN_SLOTS; ++slot)
+                for (int wk = 0; wk < SQUARE_NB; ++wk)
+                    for (int bk = 0; bk < SQUARE_NB; ++bk)
+                        label(Color(stm), slot_square(slot), Square(wk), Square(bk));
+
+        while (!won.empty()) {
+            int idx = won.back();
+            won.pop_back();
+            propagate(idx);
+        }
+    }
+};
+
+void KPKGenerator::label(Color stm, Square psq, Square wksq, Square bksq) {
+    int idx = kpk_index(stm, psq, wksq, bksq);
+    if (!is_legal(stm, wksq, bksq, psq)) {
+        state[idx] = KPK_ILLEGAL;
+        return;
+    }
+
+    if (stm == WHITE) {
+        Square promo = Square(psq + 8);
+        if (rank_of(psq) == RANK_7 && promo != wksq && promo != bksq && promotion_wins(wksq, bksq, promo))
+            mark_win(idx);
+        return;
+    }
+
+    Bitboard moves = KingAttacks[bksq] & ~KingAttacks[wksq] & ~PawnAttacks[WHITE][psq];
+    if (moves & square_bb(psq))
+        state[idx] = KPK_DRAW;                       // Takes the pawn
+    else if (!moves && (PawnAttacks[WHITE][psq] & square_bb(bksq)))
+        mark_win(idx);                               // Mated
+    else if (!moves)
+        state[idx] = KPK_DRAW;                       // Stalemated
+    else
+        escapes[idx] = uint8_t(popcount(moves));
+}
+
+void KPKGenerator::propagate(int idx) {
+    Square bksq = Square(idx % SQUARE_NB);
+    Square wksq = Square(idx / SQUARE_NB % SQUARE_NB);
+    Square psq  = slot_square(idx / (SQUARE_NB * SQUARE_NB) % KPK_PAWN_SLOTS);
+    Color  stm  = Color(idx / (SQUARE_NB * SQUARE_NB * KPK_PAWN_SLOTS));
+
+    if (stm == BLACK) {
+        // White just moved here, so the position before is won too
+        Bitboard from = KingAttacks[wksq] & ~square_bb(psq) & ~square_bb(bksq);
+        while (from) {
+            int prev = kpk_index(WHITE, psq, pop_lsb(from), bksq);
+            if (state[prev] == KPK_UNKNOWN) mark_win(prev);
+        }
+
+        Bitboard kings = square_bb(wksq) | square_bb(bksq);
+        Square behind = Square(psq - 8);
+        if (rank_of(psq) >= RANK_3 && !(kings & square_bb(behind))) {
+            int prev = kpk_index(WHITE, behind, wksq, bksq);
+            if (state[prev] == KPK_UNKNOWN) mark_win(prev);
+
+            Square start = Square(psq - 16);
+            if (rank_of(psq) == RANK_4 && !(kings & square_bb(start))) {
+                prev = kpk_index(WHITE, start, wksq, bksq);
+                if (state[prev] == KPK_UNKNOWN) mark_win(prev);
+            }
+        }
+    } else {
+        // Black just moved here: one fewer escape for the position before
+        Bitboard from = KingAttacks[bksq] & ~square_bb(psq) & ~square_bb(wksq);
+        while (from) {
+            int prev = kpk_index(BLACK, psq, wksq, pop_lsb(from));
+            if (state[prev] == KPK_UNKNOWN && --escapes[prev] == 0) mark_win(prev);
+        }
+    }
+}
+
+} // namespace
+
+void init_bitbases() {
+    KPKGenerator gen;
+    gen.run();
+
+    for (auto& w : KPKBitbase) w = 0;
+    for (int idx = 0; idx < KPK_SIZE; ++idx)
+        if (gen.state[idx] == KPK_WIN)
+            KPKBitbase[idx / 64] |= 1ULL << (idx % 64);
+}
+
+bool probe_kpk(Square wksq, Square wpsq, Square bksq, Color stm) {
+    int idx = kpk_index(stm, wpsq, wksq, bksq);
+    return KPKBitbase[idx / 64] >> (idx % 64) & 1;
+}
+
+} // namespace chess
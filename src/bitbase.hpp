@@ -0,0 +1,17 @@
+#pragma once
+
+#include "types.hpp"
+
+namespace chess {
+
+// ============================================================
+// KPK win/draw bitbase, one bit per position (24 KB), generated by
+// retrograde analysis. Call once at startup, after init_attacks.
+// ============================================================
+void init_bitbases();
+
+// Positions are normalized: the side with the pawn plays White, up the
+// board, with the pawn on files A-D. Returns true if White wins.
+bool probe_kpk(Square wksq, Square wpsq, Square bksq, Color stm);
+
+} // namespace chess
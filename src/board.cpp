@@ -35,6 +35,7 @@ void Board::set_startpos() {
 // Internal bitboard helpers
 // ============================================================
 void Board::put_piece(Piece p, Square sq) {
+    material_key_ ^= zobrist().material[p][popcount(pieces(piece_color(p), piece_type(p)))];
     board_[sq] = p;
     Bitboard bb = square_bb(sq);
     type_bb_[piece_type(p)] |= bb;
@@ -48,6 +49,7 @@ void Board::remove_piece(Square sq) {
     type_bb_[piece_type(p)] ^= bb;
     color_bb_[piece_color(p)] ^= bb;
     board_[sq] = NO_PIECE;
+    material_key_ ^= zobrist().material[p][popcount(pieces(piece_color(p), piece_type(p)))];
 }
 
 void Board::move_piece(Square from, Square to) {
@@ -63,11 +65,8 @@ void Board::move_piece(Square from, Square to) {
 // FEN parsing
 // ============================================================
 void Board::set_fen(std::string_view fen) {
-    // Clear
-    for (auto& sq : board_) sq = NO_PIECE;
-    for (auto& bb : type_bb_) bb = EMPTY_BB;
-    for (auto& bb : color_bb_) bb = EMPTY_BB;
-    history_.clear();
+    Piece pieces[SQUARE_NB];
+    for (auto& p : pieces) p = NO_PIECE;
 
     std::string fen_str(fen);
     std::istringstream ss(fen_str);
@@ -97,36 +96,55 @@ void Board::set_fen(std::string_view fen) {
                 case 'q': pt = QUEEN;  break;
                 case 'k': pt = KING;   break;
             }
-            if (pt != NO_PIECE_TYPE) {
-                put_piece(make_piece(color, pt), make_square(File(file), Rank(rank)));
+            if (pt != NO_PIECE_TYPE && file < 8 && rank >= 0) {
+                pieces[make_square(File(file), Rank(rank))] = make_piece(color, pt);
             }
             file++;
         }
     }
 
-    // Side to move
-    side_ = (side == "b") ? BLACK : WHITE;
-
     // Castling rights
-    castling_ = NO_CASTLING;
+    int rights = NO_CASTLING;
     if (castling != "-") {
         for (char c : castling) {
             switch (c) {
-                case 'K': castling_ |= WHITE_OO;  break;
-                case 'Q': castling_ |= WHITE_OOO; break;
-                case 'k': castling_ |= BLACK_OO;  break;
-                case 'q': castling_ |= BLACK_OOO; break;
+                case 'K': rights |= WHITE_OO;  break;
+                case 'Q': rights |= WHITE_OOO; break;
+                case 'k': rights |= BLACK_OO;  break;
+                case 'q': rights |= BLACK_OOO; break;
             }
         }
     }
 
-    // En passant
-    ep_square_ = (ep != "-") ? string_to_square(ep) : SQ_NONE;
+    set_position(pieces, side == "b" ? BLACK : WHITE, rights,
+                 ep != "-" ? string_to_square(ep) : SQ_NONE, hm, fm);
+}
 
-    halfmove_ = hm;
-    fullmove_ = fm;
+// Set up directly from a piece array (A1 = 0), without going through text
+void Board::set_position(const Piece (&pieces)[SQUARE_NB], Color side, int castling,
+                         Square ep, int halfmove, int fullmove) {
+    for (auto& sq : board_) sq = NO_PIECE;
+    for (auto& bb : type_bb_) bb = EMPTY_BB;
+    for (auto& bb : color_bb_) bb = EMPTY_BB;
+    material_key_ = 0;
+    history_.clear();
+
+    for (int sq = 0; sq < 64; ++sq)
+        if (pieces[sq] != NO_PIECE) put_piece(pieces[sq], Square(sq));
+
+    side_ = side;
+    castling_ = castling;
+    ep_square_ = ep;
+    halfmove_ = halfmove;
+    fullmove_ = fullmove;
 
     compute_hash();
+    if (nnue_.stack) nnue_.stack->refresh(*this);
+}
+
+void Board::attach_accumulators(nnue::AccumulatorStack* stack) {
+    nnue_.stack = stack;
+    if (stack) stack->refresh(*this);
 }
 
 std::string Board::to_fen() const {
@@ -214,6 +232,43 @@ Bitboard Board::attackers_to(Square sq, Bitboard occupied) const {
          | (KingAttacks[sq] & pieces(KING));
 }
 
+// ============================================================
+// Key after a move (mirrors the hash updates in make_move)
+// ============================================================
+uint64_t Board::key_after(Move m) const {
+    const ZobristKeys& z = zobrist();
+    Square from = m.from();
+    Square to = m.to();
+    Piece moving = board_[from];
+    Piece captured = board_[to];
+
+    uint64_t key = hash_ ^ z.side ^ z.castling[castling_]
+                 ^ z.en_passant[ep_square_ != SQ_NONE ? int(file_of(ep_square_)) : FILE_NB];
+    Square ep = SQ_NONE;
+
+    if (m.is_castling()) {
+        Square rook_from = to > from ? Square(to + 1) : Square(to - 2);
+        Square rook_to   = to > from ? Square(to - 1) : Square(to + 1);
+        Piece rook = board_[rook_from];
+        key ^= z.piece_square[moving][from] ^ z.piece_square[moving][to]
+             ^ z.piece_square[rook][rook_from] ^ z.piece_square[rook][rook_to];
+    } else if (m.is_en_passant()) {
+        Square cap_sq = make_square(file_of(to), rank_of(from));
+        key ^= z.piece_square[board_[cap_sq]][cap_sq]
+             ^ z.piece_square[moving][from] ^ z.piece_square[moving][to];
+    } else {
+        if (captured != NO_PIECE) key ^= z.piece_square[captured][to];
+        Piece placed = m.is_promotion() ? make_piece(side_, m.promotion_type()) : moving;
+        key ^= z.piece_square[moving][from] ^ z.piece_square[placed][to];
+
+        if (piece_type(moving) == PAWN && std::abs(int(to) - int(from)) == 16)
+            ep = Square((int(from) + int(to)) / 2);
+    }
+
+    int castling = castling_ & CastlingMask[from] & CastlingMask[to];
+    return key ^ z.castling[castling] ^ z.en_passant[ep != SQ_NONE ? int(file_of(ep)) : FILE_NB];
+}
+
 // ============================================================
 // Make / Unmake move
 // ============================================================
@@ -232,6 +287,7 @@ void Board::make_move(Move m) {
     Piece moving = board_[from];
     Piece captured = board_[to];
     PieceType pt = piece_type(moving);
+    nnue::DirtyPieces dirty;
 
     // Update hash: remove old castling/ep keys
     hash_ ^= zobrist().castling[castling_];
@@ -268,6 +324,9 @@ void Board::make_move(Move m) {
         hash_ ^= zobrist().piece_square[rook][rook_from];
         hash_ ^= zobrist().piece_square[rook][rook_to];
 
+        dirty.move(moving, from, to);
+        dirty.move(rook, rook_from, rook_to);
+
     } else if (m.is_en_passant()) {
         // Remove the captured pawn
         Square cap_sq = make_square(file_of(to), rank_of(from));
@@ -283,6 +342,9 @@ void Board::make_move(Move m) {
         // Store the actual captured piece in undo
         history_.back().captured = cap;
 
+        dirty.remove(cap, cap_sq);
+        dirty.move(moving, from, to);
+
     } else if (m.is_promotion()) {
         // Remove captured piece if any
         if (captured != NO_PIECE) {
@@ -298,6 +360,10 @@ void Board::make_move(Move m) {
         put_piece(promo, to);
         hash_ ^= zobrist().piece_square[promo][to];
 
+        if (captured != NO_PIECE) dirty.remove(captured, to);
+        dirty.remove(moving, from);
+        dirty.add(promo, to);
+
     } else {
         // Normal move
         if (captured != NO_PIECE) {
@@ -312,6 +378,9 @@ void Board::make_move(Move m) {
         if (pt == PAWN && std::abs(int(to) - int(from)) == 16) {
             ep_square_ = Square((int(from) + int(to)) / 2);
         }
+
+        if (captured != NO_PIECE) dirty.remove(captured, to);
+        dirty.move(moving, from, to);
     }
 
     // Update castling rights
@@ -330,6 +399,8 @@ void Board::make_move(Move m) {
     hash_ ^= zobrist().side;
 
     if (side_ == WHITE) fullmove_++;
+
+    if (nnue_.stack) nnue_.stack->push(dirty);
 }
 
 void Board::unmake_move(Move m) {
@@ -390,6 +461,7 @@ void Board::unmake_move(Move m) {
     hash_ = undo.hash;
 
     history_.pop_back();
+    if (nnue_.stack) nnue_.stack->pop();
 }
 
 void Board::make_null_move() {
@@ -413,6 +485,8 @@ void Board::make_null_move() {
 
     if (side_ == WHITE) fullmove_++;
     halfmove_++;
+
+    if (nnue_.stack) nnue_.stack->push_copy();
 }
 
 void Board::unmake_null_move() {
@@ -427,6 +501,7 @@ void Board::unmake_null_move() {
     hash_ = undo.hash;
 
     history_.pop_back();
+    if (nnue_.stack) nnue_.stack->pop();
 }
 
 } // namespace chess
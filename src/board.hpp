@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 #include "attacks.hpp"
+#include "nnue.hpp"
 #include <array>
 #include <string>
 #include <string_view>
@@ -18,6 +19,8 @@ struct ZobristKeys {
     uint64_t side;
     uint64_t castling[CASTLING_RIGHT_NB];
     uint64_t en_passant[FILE_NB + 1]; // +1 for "no ep" index 8
+    uint64_t material[PIECE_NB][SQUARE_NB + 1];  // [piece][count] for the material signature;
+                                                 // any count a malformed position can reach
 
     ZobristKeys() {
         std::mt19937_64 rng(0xDEADBEEF42ULL);
@@ -26,6 +29,8 @@ struct ZobristKeys {
         side = rng();
         for (auto& c : castling) c = rng();
         for (auto& e : en_passant) e = rng();
+        for (auto& m : material)
+            for (auto& k : m) k = rng();
     }
 };
 
@@ -45,6 +50,19 @@ struct UndoInfo {
     uint64_t hash;
 };
 
+// ============================================================
+// Non-owning link to the NNUE accumulators kept in sync by
+// make/unmake. Copies of a board are detached: they are scratch
+// boards (legality tests etc.) and must not touch the stack.
+// ============================================================
+struct AccumulatorLink {
+    nnue::AccumulatorStack* stack = nullptr;
+
+    AccumulatorLink() = default;
+    AccumulatorLink(const AccumulatorLink&) {}
+    AccumulatorLink& operator=(const AccumulatorLink&) { stack = nullptr; return *this; }
+};
+
 // ============================================================
 // Board class
 // ============================================================
@@ -54,6 +72,8 @@ public:
 
     // Setup
     void set_fen(std::string_view fen);
+    void set_position(const Piece (&pieces)[SQUARE_NB], Color side, int castling,
+                      Square ep, int halfmove, int fullmove);
     std::string to_fen() const;
     void set_startpos();
 
@@ -71,6 +91,12 @@ public:
     int     fullmove_number() const { return fullmove_; }
     uint64_t hash_key() const { return hash_; }
 
+    // Hash key of the position after a legal move, without making it
+    uint64_t key_after(Move m) const;
+
+    // Signature of the piece counts only (independent of squares)
+    uint64_t material_key() const { return material_key_; }
+
     // King square for a given color
     Square king_sq(Color c) const { return lsb(pieces(c, KING)); }
 
@@ -95,6 +121,10 @@ public:
     void make_null_move();
     void unmake_null_move();
 
+    // NNUE accumulators (nullptr to detach)
+    void attach_accumulators(nnue::AccumulatorStack* stack);
+    const nnue::AccumulatorStack* accumulators() const { return nnue_.stack; }
+
 private:
     // Piece placement
     Piece    board_[SQUARE_NB];
@@ -108,10 +138,13 @@ private:
     int      halfmove_;
     int      fullmove_;
     uint64_t hash_;
+    uint64_t material_key_;
 
     // Undo history
     std::vector<UndoInfo> history_;
 
+    AccumulatorLink nnue_;
+
     // Internal helpers
     void put_piece(Piece p, Square sq);
     void remove_piece(Square sq);
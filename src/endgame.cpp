@@ -0,0 +1,133 @@
+#include "endgame.hpp"
+#include "bitbase.hpp"
+#include "movegen.hpp"
+#include <algorithm>
+
+namespace chess {
+
+// ============================================================
+// Helpers
+// ============================================================
+
+// Bonus for driving the defending king to the edge (corner = 100, centre = 10)
+static int push_to_edge(Square s) {
+    int fd = std::min<int>(file_of(s), 7 - file_of(s));
+    int rd = std::min<int>(rank_of(s), 7 - rank_of(s));
+    return 100 - 10 * (fd + rd) - 10 * std::min(fd, rd);
+}
+
+// Bonus for driving the defending king to an a1/h8 corner
+static int push_to_corner(Square s) {
+    int d_a1 = int(file_of(s)) + int(rank_of(s));
+    int d_h8 = (7 - int(file_of(s))) + (7 - int(rank_of(s)));
+    return 20 * (14 - std::min(d_a1, d_h8));
+}
+
+// Bonus for bringing the attacking king close to the defending one
+static int push_close(Square a, Square b) {
+    return 140 - 20 * distance(a, b);
+}
+
+// Mirror a square so that 'strong' plays up the board as White
+static Square relative_square(Color c, Square s) {
+    return c == WHITE ? s : Square(s ^ 56);
+}
+
+static int non_king_material(const Board& board, Color c) {
+    int v = 0;
+    for (int pt = PAWN; pt <= QUEEN; ++pt)
+        v += popcount(board.pieces(c, PieceType(pt))) * PieceValue[pt];
+    return v;
+}
+
+static int relative_to_stm(const Board& board, Color strong, int v) {
+    return board.side_to_move() == strong ? v : -v;
+}
+
+// ============================================================
+// Evaluators
+// ============================================================
+int eval_draw(const Board&, Color) {
+    return VALUE_DRAW;
+}
+
+int eval_kxk(const Board& board, Color strong) {
+    // Stalemate detection must be done here, the search only sees a leaf
+    if (board.side_to_move() != strong && !board.in_check()) {
+        MoveList moves;
+        generate_moves(board, moves);
+        if (moves.count == 0) return VALUE_DRAW;
+    }
+
+    Square strong_king = board.king_sq(strong);
+    Square weak_king = board.king_sq(~strong);
+
+    int v = non_king_material(board, strong)
+          + push_to_edge(weak_king)
+          + push_close(strong_king, weak_king);
+
+    Bitboard bishops = board.pieces(strong, BISHOP);
+    if (board.pieces(strong, QUEEN) || board.pieces(strong, ROOK)
+        || (bishops && board.pieces(strong, KNIGHT))
+        || ((bishops & DARK_SQUARES) && (bishops & ~DARK_SQUARES)))
+        v = std::min(v + VALUE_KNOWN_WIN, MATE_IN_MAX_PLY - 1);
+
+    return relative_to_stm(board, strong, v);
+}
+
+int eval_kbnk(const Board& board, Color strong) {
+    Square strong_king = board.king_sq(strong);
+    Square weak_king = board.king_sq(~strong);
+
+    // Mate is only possible in a corner of the bishop's colour. Flip the
+    // board horizontally for a light-squared bishop so a1/h8 is the target.
+    if (!(board.pieces(strong, BISHOP) & DARK_SQUARES))
+        weak_king = Square(weak_king ^ 7);
+
+    int v = VALUE_KNOWN_WIN + PieceValue[BISHOP] + PieceValue[KNIGHT]
+          + push_close(strong_king, weak_king)
+          + push_to_corner(weak_king);
+
+    return relative_to_stm(board, strong, v);
+}
+
+bool kpk_win(const Board& board, Color strong) {
+    Square strong_king = relative_square(strong, board.king_sq(strong));
+    Square weak_king = relative_square(strong, board.king_sq(~strong));
+    Square pawn = relative_square(strong, lsb(board.pieces(strong, PAWN)));
+
+    // The bitbase only stores pawns on files A-D
+    if (file_of(pawn) >= FILE_E) {
+        strong_king = Square(strong_king ^ 7);
+        weak_king = Square(weak_king ^ 7);
+        pawn = Square(pawn ^ 7);
+    }
+
+    Color us = board.side_to_move() == strong ? WHITE : BLACK;
+    return probe_kpk(strong_king, pawn, weak_king, us);
+}
+
+int eval_kpk(const Board& board, Color strong) {
+    if (!kpk_win(board, strong)) return VALUE_DRAW;
+
+    // Exact win: prefer advancing the pawn so the search makes progress
+    Square pawn = relative_square(strong, lsb(board.pieces(strong, PAWN)));
+    int v = VALUE_KNOWN_WIN + PieceValue[PAWN] + 10 * rank_of(pawn);
+    return relative_to_stm(board, strong, v);
+}
+
+// ============================================================
+// Scaling functions
+// ============================================================
+int scale_ocb(const Board& board, Color strong) {
+    Bitboard bishops = board.pieces(BISHOP);
+    if (!(bishops & DARK_SQUARES) || !(bishops & ~DARK_SQUARES))
+        return SCALE_FACTOR_NONE;
+
+    // Pure opposite-coloured bishop endings are very drawish, more so when
+    // the pawn majority is small
+    int pawn_diff = popcount(board.pieces(strong, PAWN)) - popcount(board.pieces(~strong, PAWN));
+    return pawn_diff <= 1 ? 16 : 32;
+}
+
+} // namespace chess
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "board.hpp"
+
+namespace chess {
+
+// ============================================================
+// Scale factors applied to the endgame score (64 = unscaled)
+// ============================================================
+constexpr int SCALE_FACTOR_DRAW   = 0;
+constexpr int SCALE_FACTOR_NORMAL = 64;
+constexpr int SCALE_FACTOR_NONE   = 255; // "no opinion", use the default
+
+// Specialized evaluator for a known ending. 'strong' is the side with
+// the winning material; the result is relative to the side to move.
+using EndgameEval = int (*)(const Board& board, Color strong);
+
+// Scaling function for a known ending. Returns a scale factor for the
+// endgame score of 'strong', or SCALE_FACTOR_NONE.
+using EndgameScale = int (*)(const Board& board, Color strong);
+
+// Evaluators
+int eval_draw(const Board& board, Color strong);  // KK, KNK, KBK, KNNK
+int eval_kxk(const Board& board, Color strong);   // Mating material vs lone king
+int eval_kbnk(const Board& board, Color strong);  // KBN vs K
+int eval_kpk(const Board& board, Color strong);   // KP vs K, exact from the bitbase
+
+// Exact KPK result: true if 'strong' (the side with the pawn) wins
+bool kpk_win(const Board& board, Color strong);
+
+// Scaling functions
+int scale_ocb(const Board& board, Color strong);  // Opposite-coloured bishops
+
+} // namespace chess
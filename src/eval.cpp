@@ -1,270 +1,211 @@
 #include "eval.hpp"
+#include "eval_params.hpp"
+#include "material.hpp"
 #include "movegen.hpp"
+#include "nnue.hpp"
 
 namespace chess {
 
-// ============================================================
-// Piece-Square Tables (from White's perspective, A1=index 0)
-// Midgame (mg) and Endgame (eg) values
-// ============================================================
-
-// Pawn PST
-static constexpr int PawnMG[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-    50, 50, 50, 50, 50, 50, 50, 50,
-    10, 10, 20, 40, 40, 20, 10, 10,
-     5,  5, 15, 30, 30, 15,  5,  5,
-     0,  0, 10, 25, 25, 10,  0,  0,
-     5, -5,-10,  0,  0,-10, -5,  5,
-     5, 10, 10,-20,-20, 10, 10,  5,
-     0,  0,  0,  0,  0,  0,  0,  0,
-};
+using namespace params;
 
-static constexpr int PawnEG[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-    80, 80, 80, 80, 80, 80, 80, 80,
-    50, 50, 50, 50, 50, 50, 50, 50,
-    30, 30, 30, 30, 30, 30, 30, 30,
-    20, 20, 20, 20, 20, 20, 20, 20,
-    10, 10, 10, 10, 10, 10, 10, 10,
-     5,  5,  5,  5,  5,  5,  5,  5,
-     0,  0,  0,  0,  0,  0,  0,  0,
+// PST lookup: [piece_type][square]
+static constexpr const Score* PST[PIECE_TYPE_NB] = {
+    nullptr, PawnPST, KnightPST, BishopPST, RookPST, QueenPST, KingPST
 };
 
-// Knight PST
-static constexpr int KnightMG[64] = {
-    -50,-40,-30,-30,-30,-30,-40,-50,
-    -40,-20,  0,  5,  5,  0,-20,-40,
-    -30,  5, 10, 15, 15, 10,  5,-30,
-    -30,  0, 15, 20, 20, 15,  0,-30,
-    -30,  5, 15, 20, 20, 15,  5,-30,
-    -30,  0, 10, 15, 15, 10,  0,-30,
-    -40,-20,  0,  0,  0,  0,-20,-40,
-    -50,-40,-30,-30,-30,-30,-40,-50,
-};
-
-static constexpr int KnightEG[64] = {
-   -50,-40,-30,-30,-30,-30,-40,-50,
-   -40,-20,  0,  0,  0,  0,-20,-40,
-   -30,  0, 10, 15, 15, 10,  0,-30,
-   -30,  5, 15, 20, 20, 15,  5,-30,
-   -30,  0, 15, 20, 20, 15,  0,-30,
-   -30,  5, 10, 15, 15, 10,  5,-30,
-   -40,-20,  0,  5,  5,  0,-20,-40,
-   -50,-40,-30,-30,-30,-30,-40,-50,
-};
+// Largest swing the terms skipped by lazy evaluation (pawn structure,
+// passed pawns, mobility, king safety) can plausibly add on top of
+// material + PST
+static constexpr int LazyMargin = 500;
 
-// Bishop PST
-static constexpr int BishopMG[64] = {
-   -20,-10,-10,-10,-10,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5, 10, 10,  5,  0,-10,
-   -10,  5,  5, 10, 10,  5,  5,-10,
-   -10,  0, 10, 10, 10, 10,  0,-10,
-   -10, 10, 10, 10, 10, 10, 10,-10,
-   -10,  5,  0,  0,  0,  0,  5,-10,
-   -20,-10,-10,-10,-10,-10,-10,-20,
-};
-
-static constexpr int BishopEG[64] = {
-   -20,-10,-10,-10,-10,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5, 10, 10,  5,  0,-10,
-   -10,  5,  5, 10, 10,  5,  5,-10,
-   -10,  0, 10, 10, 10, 10,  0,-10,
-   -10, 10, 10, 10, 10, 10, 10,-10,
-   -10,  5,  0,  0,  0,  0,  5,-10,
-   -20,-10,-10,-10,-10,-10,-10,-20,
-};
-
-// Rook PST
-static constexpr int RookMG[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-     5, 10, 10, 10, 10, 10, 10,  5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-     0,  0,  0,  5,  5,  0,  0,  0,
-};
+// Mirror square for black (flip rank)
+static constexpr int mirror_sq(int sq) {
+    return sq ^ 56;  // flip rank: rank 0 <-> rank 7
+}
 
-static constexpr int RookEG[64] = {
-     0,  0,  0,  0,  0,  0,  0,  0,
-     5, 10, 10, 10, 10, 10, 10,  5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-     0,  0,  0,  5,  5,  0,  0,  0,
+// Material + PST fused per piece at compile time: White entries as
+// tuned, Black entries mirrored and negated, so the sum over all pieces
+// is White's score with one load per piece
+struct PsqTable {
+    Score values[PIECE_NB][SQUARE_NB];
 };
 
-// Queen PST
-static constexpr int QueenMG[64] = {
-   -20,-10,-10, -5, -5,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5,  5,  5,  5,  0,-10,
-    -5,  0,  5,  5,  5,  5,  0, -5,
-     0,  0,  5,  5,  5,  5,  0, -5,
-   -10,  5,  5,  5,  5,  5,  0,-10,
-   -10,  0,  5,  0,  0,  0,  0,-10,
-   -20,-10,-10, -5, -5,-10,-10,-20,
-};
+static constexpr PsqTable make_psq_table() {
+    PsqTable t{};
+    for (int pt = PAWN; pt <= KING; ++pt)
+        for (int sq = 0; sq < 64; ++sq) {
+            Score s = Material[pt] + PST[pt][sq];
+            t.values[make_piece(WHITE, PieceType(pt))][sq] = s;
+            t.values[make_piece(BLACK, PieceType(pt))][mirror_sq(sq)] = -s;
+        }
+    return t;
+}
 
-static constexpr int QueenEG[64] = {
-   -20,-10,-10, -5, -5,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5,  5,  5,  5,  0,-10,
-    -5,  0,  5,  5,  5,  5,  0, -5,
-     0,  0,  5,  5,  5,  5,  0, -5,
-   -10,  5,  5,  5,  5,  5,  0,-10,
-   -10,  0,  5,  0,  0,  0,  0,-10,
-   -20,-10,-10, -5, -5,-10,-10,-20,
-};
+static constexpr PsqTable PSQ = make_psq_table();
 
-// King PST
-static constexpr int KingMG[64] = {
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -20,-30,-30,-40,-40,-30,-30,-20,
-   -10,-20,-20,-20,-20,-20,-20,-10,
-    20, 20,  0,  0,  0,  0, 20, 20,
-    20, 30, 10,  0,  0, 10, 30, 20,
-};
+// ============================================================
+// Evaluation
+// With Trace, the coefficient of every weight is recorded for tuning.
+// With Lazy, material + PST is returned early when it is far enough
+// outside [alpha, beta] that the remaining terms cannot matter.
+// ============================================================
 
-static constexpr int KingEG[64] = {
-   -50,-40,-30,-20,-20,-30,-40,-50,
-   -30,-20,-10,  0,  0,-10,-20,-30,
-   -30,-10, 20, 30, 30, 20,-10,-30,
-   -30,-10, 30, 40, 40, 30,-10,-30,
-   -30,-10, 30, 40, 40, 30,-10,-30,
-   -30,-10, 20, 30, 30, 20,-10,-30,
-   -30,-30,  0,  0,  0,  0,-30,-30,
-   -50,-30,-30,-30,-30,-30,-30,-50,
-};
+// Blend a packed score by game phase, from the side to move's view
+static int taper(const Board& board, const MaterialEntry* me, Score total, int* scale = nullptr) {
+    int mg = mg_value(total);
+    int eg = eg_value(total);
 
-// PST lookup: [piece_type][square] for MG and EG
-static constexpr const int* PST_MG[PIECE_TYPE_NB] = {
-    nullptr, PawnMG, KnightMG, BishopMG, RookMG, QueenMG, KingMG
-};
-static constexpr const int* PST_EG[PIECE_TYPE_NB] = {
-    nullptr, PawnEG, KnightEG, BishopEG, RookEG, QueenEG, KingEG
-};
+    // Scale down the endgame part in drawish material configurations
+    int sf = me->scale_factor(board, eg > 0 ? WHITE : BLACK);
+    eg = eg * sf / SCALE_FACTOR_NORMAL;
+    if (scale) *scale = sf;
 
-// Phase weights per piece type
-static constexpr int PhaseWeight[PIECE_TYPE_NB] = {
-    0, 0, 1, 1, 2, 4, 0
-};
-static constexpr int TOTAL_PHASE = 24; // 4*1(N) + 4*1(B) + 4*2(R) + 2*4(Q)
+    int v = (mg * me->phase + eg * (TOTAL_PHASE - me->phase)) / TOTAL_PHASE;
 
-// Mirror square for black (flip rank)
-static constexpr int mirror_sq(int sq) {
-    return sq ^ 56;  // flip rank: rank 0 <-> rank 7
+    // Return relative to side to move
+    return (board.side_to_move() == WHITE) ? v : -v;
 }
 
-// ============================================================
-// Evaluation
-// ============================================================
-int evaluate(const Board& board) {
-    int mg_score[COLOR_NB] = {0, 0};
-    int eg_score[COLOR_NB] = {0, 0};
-    int phase = 0;
+template <bool Trace, bool Lazy>
+static int evaluate_classical(const Board& board, std::optional<AttackInfo>& ai, const MaterialEntry* me,
+                              EvalTrace* trace, int alpha = 0, int beta = 0, bool* lazy = nullptr) {
+    Score score[COLOR_NB] = {SCORE_ZERO, SCORE_ZERO};
 
     // Material + PST
-    for (int sq = 0; sq < 64; ++sq) {
-        Piece p = board.piece_on(Square(sq));
-        if (p == NO_PIECE) continue;
-
-        Color c = piece_color(p);
-        PieceType pt = piece_type(p);
-
-        // Material
-        mg_score[c] += PieceValue[pt];
-        eg_score[c] += PieceValue[pt];
+    if constexpr (Trace) {
+        // Unfused, so every weight's coefficient can be recorded
+        for (int sq = 0; sq < 64; ++sq) {
+            Piece p = board.piece_on(Square(sq));
+            if (p == NO_PIECE) continue;
+
+            Color c = piece_color(p);
+            PieceType pt = piece_type(p);
+
+            // PST (tables are from White's perspective)
+            int pst_sq = (c == WHITE) ? sq : mirror_sq(sq);
+            score[c] += Material[pt] + PST[pt][pst_sq];
+            trace->material[pt][c]++;
+            trace->psqt[pt][pst_sq][c]++;
+        }
+    } else {
+        Bitboard occ = board.occupied();
+        while (occ) {
+            Square sq = pop_lsb(occ);
+            score[WHITE] += PSQ.values[board.piece_on(sq)][sq];
+        }
+    }
 
-        // Phase
-        phase += PhaseWeight[pt];
+    // Bishop pair (the material table holds the weighted sum)
+    score[WHITE] += me->imbalance;
 
-        // PST (tables are from White's perspective)
-        int pst_sq = (c == WHITE) ? sq : mirror_sq(sq);
-        mg_score[c] += PST_MG[pt][pst_sq];
-        eg_score[c] += PST_EG[pt][pst_sq];
+    if constexpr (Lazy) {
+        int v = taper(board, me, score[WHITE] - score[BLACK]);
+        if (v > beta + LazyMargin || v < alpha - LazyMargin) {
+            *lazy = true;
+            return v;
+        }
+        *lazy = false;
+    }
+    if constexpr (Trace) {
+        for (int c = 0; c < 2; ++c)
+            trace->bishop_pair[c] = popcount(board.pieces(Color(c), BISHOP)) >= 2;
     }
 
-    // Pawn structure: doubled and isolated pawns
+    // Pawn structure, set-wise for all files at once
     for (int c = 0; c < 2; ++c) {
-        Bitboard pawns = board.pieces(Color(c), PAWN);
-
-        for (int f = 0; f < 8; ++f) {
-            Bitboard file_pawns = pawns & file_bb(File(f));
-            int count = popcount(file_pawns);
-
-            // Doubled pawns penalty
-            if (count > 1) {
-                mg_score[c] -= 10 * (count - 1);
-                eg_score[c] -= 20 * (count - 1);
-            }
-
-            // Isolated pawn penalty
-            if (file_pawns) {
-                Bitboard adj = EMPTY_BB;
-                if (f > 0) adj |= file_bb(File(f - 1));
-                if (f < 7) adj |= file_bb(File(f + 1));
-                if (!(pawns & adj)) {
-                    mg_score[c] -= 15 * count;
-                    eg_score[c] -= 20 * count;
-                }
-            }
+        Color us = Color(c), them = ~us;
+        Bitboard ours = board.pieces(us, PAWN);
+        Bitboard theirs = board.pieces(them, PAWN);
+
+        // Pawns with an own pawn further up the file (count - 1 per file)
+        Bitboard doubled = ours & rear_span(us, ours);
+
+        // Pawns with no own pawns on adjacent files
+        Bitboard files = file_fill(ours);
+        Bitboard isolated = ours & ~(shift_east(files) | shift_west(files));
+
+        // Stop square attacked by an enemy pawn and never coverable by
+        // an own pawn advancing on an adjacent file
+        Bitboard stops = shift_up(us, ours);
+        Bitboard backward = shift_up(them, stops & pawn_attacks_bb(them, theirs) & ~attack_span(us, ours))
+                          & ~isolated;
+
+        // Defended by a pawn or standing next to one
+        Bitboard connected = ours & (pawn_attacks_bb(us, ours) | shift_east(ours) | shift_west(ours));
+
+        // No enemy pawn ahead on this or an adjacent file, front pawn only
+        Bitboard passed = ours & ~(front_span(them, theirs) | attack_span(them, theirs)) & ~doubled;
+
+        score[c] += Doubled * popcount(doubled);
+        score[c] += Isolated * popcount(isolated);
+        score[c] += Backward * popcount(backward);
+        score[c] += Connected * popcount(connected);
+        if constexpr (Trace) {
+            trace->doubled[c] = popcount(doubled);
+            trace->isolated[c] = popcount(isolated);
+            trace->backward[c] = popcount(backward);
+            trace->connected[c] = popcount(connected);
+        }
+
+        while (passed) {
+            Rank r = relative_rank(us, pop_lsb(passed));
+            score[c] += PassedPawn[r];
+            if constexpr (Trace) trace->passed[r][c]++;
         }
     }
 
-    // Simple mobility: count attacks for knights, bishops, rooks, queens
-    Bitboard occ = board.occupied();
+    // Mobility and king safety from the shared attack maps
+    if (!ai) ai.emplace(board);
     for (int c = 0; c < 2; ++c) {
-        Color col = Color(c);
-        int mobility = 0;
-
-        // Knights
-        Bitboard bb = board.pieces(col, KNIGHT);
-        while (bb) {
-            Square sq = pop_lsb(bb);
-            mobility += popcount(KnightAttacks[sq] & ~board.pieces(col));
-        }
-        // Bishops
-        bb = board.pieces(col, BISHOP);
-        while (bb) {
-            Square sq = pop_lsb(bb);
-            mobility += popcount(get_bishop_attacks(sq, occ) & ~board.pieces(col));
-        }
-        // Rooks
-        bb = board.pieces(col, ROOK);
-        while (bb) {
-            Square sq = pop_lsb(bb);
-            mobility += popcount(get_rook_attacks(sq, occ) & ~board.pieces(col));
-        }
-        // Queens
-        bb = board.pieces(col, QUEEN);
-        while (bb) {
-            Square sq = pop_lsb(bb);
-            mobility += popcount(get_queen_attacks(sq, occ) & ~board.pieces(col));
+        score[c] += Mobility * ai->mobility[c];
+        score[c] += KingAttack * ai->king_attacks[c];
+        if constexpr (Trace) {
+            trace->mobility[c] = ai->mobility[c];
+            trace->king_attacks[c] = ai->king_attacks[c];
         }
+    }
 
-        mg_score[c] += mobility * 3;
-        eg_score[c] += mobility * 2;
+    // Tapered evaluation: unpack the (mg, eg) pair once
+    int sf;
+    int v = taper(board, me, score[WHITE] - score[BLACK], &sf);
+
+    if constexpr (Trace) {
+        trace->phase = me->phase;
+        trace->scale = sf;
     }
+    return v;
+}
 
-    // Tapered evaluation
-    if (phase > TOTAL_PHASE) phase = TOTAL_PHASE;
-    int mg = mg_score[WHITE] - mg_score[BLACK];
-    int eg = eg_score[WHITE] - eg_score[BLACK];
+int evaluate(const Board& board) {
+    // Known endings are evaluated exactly by a specialized function
+    const MaterialEntry* me = probe_material(board);
+    if (me->has_eval()) return me->evaluate(board);
 
-    int score = (mg * phase + eg * (TOTAL_PHASE - phase)) / TOTAL_PHASE;
+    if (nnue::enabled()) return nnue::evaluate(board);
 
-    // Return relative to side to move
-    return (board.side_to_move() == WHITE) ? score : -score;
+    std::optional<AttackInfo> ai;
+    return evaluate_classical<false, false>(board, ai, me, nullptr);
+}
+
+int evaluate(const Board& board, std::optional<AttackInfo>& ai, int alpha, int beta, bool& lazy) {
+    lazy = false;
+    const MaterialEntry* me = probe_material(board);
+    if (me->has_eval()) return me->evaluate(board);
+
+    if (nnue::enabled()) return nnue::evaluate(board);
+
+    return evaluate_classical<false, true>(board, ai, me, nullptr, alpha, beta, &lazy);
+}
+
+int evaluate_trace(const Board& board, EvalTrace& trace) {
+    trace = EvalTrace{};
+    const MaterialEntry* me = probe_material(board);
+    if (me->has_eval()) {
+        trace.known_ending = true;
+        return me->evaluate(board);
+    }
+    std::optional<AttackInfo> ai;
+    return evaluate_classical<true, false>(board, ai, me, &trace);
 }
 
 } // namespace chess
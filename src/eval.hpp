@@ -1,6 +1,8 @@
 #pragma once
 
+#include "attackinfo.hpp"
 #include "board.hpp"
+#include <optional>
 
 namespace chess {
 
@@ -8,4 +10,37 @@ namespace chess {
 // Positive = advantage for side to move.
 int evaluate(const Board& board);
 
+// Window-aware evaluation. When material + PST alone is more than a safe
+// margin outside [alpha, beta], that cheap score is returned and 'lazy'
+// is set; otherwise the full evaluation is computed and 'lazy' is false.
+// Only the full evaluation needs attack information: if 'ai' is empty
+// it is built there, so a lazy exit never pays for it and the caller
+// can reuse it afterwards.
+int evaluate(const Board& board, std::optional<AttackInfo>& ai, int alpha, int beta, bool& lazy);
+
+// ============================================================
+// Evaluation trace for tuning: the coefficient of every weight in
+// eval_params.hpp, per colour. The classical score is linear in the
+// weights given phase and scale, except in known endings.
+// ============================================================
+struct EvalTrace {
+    int material[PIECE_TYPE_NB][COLOR_NB];
+    int psqt[PIECE_TYPE_NB][SQUARE_NB][COLOR_NB];
+    int doubled[COLOR_NB];
+    int isolated[COLOR_NB];
+    int backward[COLOR_NB];
+    int connected[COLOR_NB];
+    int passed[RANK_NB][COLOR_NB];
+    int mobility[COLOR_NB];
+    int king_attacks[COLOR_NB];
+    int bishop_pair[COLOR_NB];
+
+    int  phase;
+    int  scale;
+    bool known_ending;
+};
+
+// Classical evaluation (never NNUE) that also fills in the trace
+int evaluate_trace(const Board& board, EvalTrace& trace);
+
 } // namespace chess
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "types.hpp"
+
+// ============================================================
+// Classical evaluation weights as packed (midgame, endgame) scores.
+//
+// This file is regenerated by tools/tune.cpp; keep the layout
+// (names, 8 values per row, A1 = index 0) when editing by hand.
+// ============================================================
+
+namespace chess::params {
+
+constexpr Score S(int mg, int eg) { return make_score(mg, eg); }
+
+// Material
+inline constexpr Score Material[PIECE_TYPE_NB] = {
+    S(   0,   0), S( 100, 100), S( 320, 320), S( 330, 330), S( 500, 500), S( 900, 900), S(   0,   0),
+};
+
+// ============================================================
+// Piece-Square Tables (from White's perspective, A1=index 0)
+// ============================================================
+
+inline constexpr Score PawnPST[64] = {
+    S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0),
+    S(  50,  80), S(  50,  80), S(  50,  80), S(  50,  80), S(  50,  80), S(  50,  80), S(  50,  80), S(  50,  80),
+    S(  10,  50), S(  10,  50), S(  20,  50), S(  40,  50), S(  40,  50), S(  20,  50), S(  10,  50), S(  10,  50),
+    S(   5,  30), S(   5,  30), S(  15,  30), S(  30,  30), S(  30,  30), S(  15,  30), S(   5,  30), S(   5,  30),
+    S(   0,  20), S(   0,  20), S(  10,  20), S(  25,  20), S(  25,  20), S(  10,  20), S(   0,  20), S(   0,  20),
+    S(   5,  10), S(  -5,  10), S( -10,  10), S(   0,  10), S(   0,  10), S( -10,  10), S(  -5,  10), S(   5,  10),
+    S(   5,   5), S(  10,   5), S(  10,   5), S( -20,   5), S( -20,   5), S(  10,   5), S(  10,   5), S(   5,   5),
+    S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0),
+};
+
+inline constexpr Score KnightPST[64] = {
+    S( -50, -50), S( -40, -40), S( -30, -30), S( -30, -30), S( -30, -30), S( -30, -30), S( -40, -40), S( -50, -50),
+    S( -40, -40), S( -20, -20), S(   0,   0), S(   5,   0), S(   5,   0), S(   0,   0), S( -20, -20), S( -40, -40),
+    S( -30, -30), S(   5,   0), S(  10,  10), S(  15,  15), S(  15,  15), S(  10,  10), S(   5,   0), S( -30, -30),
+    S( -30, -30), S(   0,   5), S(  15,  15), S(  20,  20), S(  20,  20), S(  15,  15), S(   0,   5), S( -30, -30),
+    S( -30, -30), S(   5,   0), S(  15,  15), S(  20,  20), S(  20,  20), S(  15,  15), S(   5,   0), S( -30, -30),
+    S( -30, -30), S(   0,   5), S(  10,  10), S(  15,  15), S(  15,  15), S(  10,  10), S(   0,   5), S( -30, -30),
+    S( -40, -40), S( -20, -20), S(   0,   0), S(   0,   5), S(   0,   5), S(   0,   0), S( -20, -20), S( -40, -40),
+    S( -50, -50), S( -40, -40), S( -30, -30), S( -30, -30), S( -30, -30), S( -30, -30), S( -40, -40), S( -50, -50),
+};
+
+inline constexpr Score BishopPST[64] = {
+    S( -20, -20), S( -10, -10), S( -10, -10), S( -10, -10), S( -10, -10), S( -10, -10), S( -10, -10), S( -20, -20),
+    S( -10, -10), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S( -10, -10),
+    S( -10, -10), S(   0,   0), S(   5,   5), S(  10,  10), S(  10,  10), S(   5,   5), S(   0,   0), S( -10, -10),
+    S( -10, -10), S(   5,   5), S(   5,   5), S(  10,  10), S(  10,  10), S(   5,   5), S(   5,   5), S( -10, -10),
+    S( -10, -10), S(   0,   0), S(  10,  10), S(  10,  10), S(  10,  10), S(  10,  10), S(   0,   0), S( -10, -10),
+    S( -10, -10), S(  10,  10), S(  10,  10), S(  10,  10), S(  10,  10), S(  10,  10), S(  10,  10), S( -10, -10),
+    S( -10, -10), S(   5,   5), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   5,   5), S( -10, -10),
+    S( -20, -20), S( -10, -10), S( -10, -10), S( -10, -10), S( -10, -10), S( -10, -10), S( -10, -10), S( -20, -20),
+};
+
+inline constexpr Score RookPST[64] = {
+    S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0),
+    S(   5,   5), S(  10,  10), S(  10,  10), S(  10,  10), S(  10,  10), S(  10,  10), S(  10,  10), S(   5,   5),
+    S(  -5,  -5), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(  -5,  -5),
+    S(  -5,  -5), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(  -5,  -5),
+    S(  -5,  -5), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(  -5,  -5),
+    S(  -5,  -5), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(  -5,  -5),
+    S(  -5,  -5), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(  -5,  -5),
+    S(   0,   0), S(   0,   0), S(   0,   0), S(   5,   5), S(   5,   5), S(   0,   0), S(   0,   0), S(   0,   0),
+};
+
+inline constexpr Score QueenPST[64] = {
+    S( -20, -20), S( -10, -10), S( -10, -10), S(  -5,  -5), S(  -5,  -5), S( -10, -10), S( -10, -10), S( -20, -20),
+    S( -10, -10), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S( -10, -10),
+    S( -10, -10), S(   0,   0), S(   5,   5), S(   5,   5), S(   5,   5), S(   5,   5), S(   0,   0), S( -10, -10),
+    S(  -5,  -5), S(   0,   0), S(   5,   5), S(   5,   5), S(   5,   5), S(   5,   5), S(   0,   0), S(  -5,  -5),
+    S(   0,   0), S(   0,   0), S(   5,   5), S(   5,   5), S(   5,   5), S(   5,   5), S(   0,   0), S(  -5,  -5),
+    S( -10, -10), S(   5,   5), S(   5,   5), S(   5,   5), S(   5,   5), S(   5,   5), S(   0,   0), S( -10, -10),
+    S( -10, -10), S(   0,   0), S(   5,   5), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S( -10, -10),
+    S( -20, -20), S( -10, -10), S( -10, -10), S(  -5,  -5), S(  -5,  -5), S( -10, -10), S( -10, -10), S( -20, -20),
+};
+
+inline constexpr Score KingPST[64] = {
+    S( -30, -50), S( -40, -40), S( -40, -30), S( -50, -20), S( -50, -20), S( -40, -30), S( -40, -40), S( -30, -50),
+    S( -30, -30), S( -40, -20), S( -40, -10), S( -50,   0), S( -50,   0), S( -40, -10), S( -40, -20), S( -30, -30),
+    S( -30, -30), S( -40, -10), S( -40,  20), S( -50,  30), S( -50,  30), S( -40,  20), S( -40, -10), S( -30, -30),
+    S( -30, -30), S( -40, -10), S( -40,  30), S( -50,  40), S( -50,  40), S( -40,  30), S( -40, -10), S( -30, -30),
+    S( -20, -30), S( -30, -10), S( -30,  30), S( -40,  40), S( -40,  40), S( -30,  30), S( -30, -10), S( -20, -30),
+    S( -10, -30), S( -20, -10), S( -20,  20), S( -20,  30), S( -20,  30), S( -20,  20), S( -20, -10), S( -10, -30),
+    S(  20, -30), S(  20, -30), S(   0,   0), S(   0,   0), S(   0,   0), S(   0,   0), S(  20, -30), S(  20, -30),
+    S(  20, -50), S(  30, -30), S(  10, -30), S(   0, -30), S(   0, -30), S(  10, -30), S(  30, -30), S(  20, -50),
+};
+
+// Pawn structure
+inline constexpr Score Doubled = S( -10, -20);
+inline constexpr Score Isolated = S( -15, -20);
+inline constexpr Score Backward = S(  -8, -10);
+inline constexpr Score Connected = S(   5,   5);
+
+// Passed pawns, by relative rank
+inline constexpr Score PassedPawn[RANK_NB] = {
+    S(   0,   0), S(   0,   5), S(   5,  10), S(  10,  20), S(  20,  40), S(  35,  70), S(  60, 110), S(   0,   0),
+};
+
+// Mobility, per attacked square not occupied by own pieces
+inline constexpr Score Mobility = S(   3,   2);
+
+// King safety, per enemy attack on the king zone
+inline constexpr Score KingAttack = S(  -6,   0);
+
+// Bishop pair
+inline constexpr Score BishopPair = S(  30,  50);
+
+} // namespace chess::params
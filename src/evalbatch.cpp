@@ -0,0 +1,151 @@
+#include "evalbatch.hpp"
+#include "eval.hpp"
+#include "nnue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+namespace chess {
+
+// Split [0, count) into contiguous blocks, one per worker, keeping the
+// input order within a block. 'work' returns how many positions of its
+// block it rejected; the total is returned.
+template <typename Work>
+static size_t split_blocks(size_t count, int threads, Work work) {
+    if (threads <= 0) threads = std::max(1, int(std::thread::hardware_concurrency()));
+    threads = int(std::min<size_t>(threads, std::max<size_t>(count / 1024, 1)));
+
+    if (threads == 1) return work(size_t(0), count);
+
+    std::atomic<size_t> rejected{0};
+    std::vector<std::thread> pool;
+    size_t block = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        size_t begin = std::min(count, t * block);
+        size_t end = std::min(count, begin + block);
+        pool.emplace_back([&, begin, end] { rejected += work(begin, end); });
+    }
+    for (auto& th : pool) th.join();
+    return rejected;
+}
+
+// Each worker owns one scratch board for the whole block, so setting up
+// a position never allocates and the thread-local material table stays
+// warm across consecutive positions. 'setup' returns nullptr for a
+// position it rejects, which scores VALUE_NONE.
+template <typename Setup>
+static size_t run_batch(size_t count, int* scores, int threads, Setup setup) {
+    return split_blocks(count, threads, [&](size_t begin, size_t end) {
+        Board board;
+        size_t bad = 0;
+        for (size_t i = begin; i < end; ++i) {
+            const Board* b = setup(i, board);
+            scores[i] = b ? evaluate(*b) : VALUE_NONE;
+            bad += !b;
+        }
+        return bad;
+    });
+}
+
+// NNUE over packed records: decode a chunk straight into feature sets,
+// then run it through nnue::evaluate_batch in input order. Known endings
+// (all of which have a lone king) still need evaluate() and a Board.
+static size_t nnue_batch(const PackedPosition* positions, size_t begin, size_t end, int* scores) {
+    constexpr size_t CHUNK = 1024;
+    std::vector<nnue::FeatureSet> features(CHUNK);
+    std::vector<Color> stm(CHUNK);
+    std::vector<size_t> index(CHUNK);
+    std::vector<int> out(CHUNK);
+    Board board;
+    size_t rejected = 0;
+
+    for (size_t base = begin; base < end; base += CHUNK) {
+        size_t n = 0;
+        for (size_t i = base; i < std::min(end, base + CHUNK); ++i) {
+            Piece pieces[SQUARE_NB];
+            if (!unpack_pieces(positions[i], pieces)) {
+                scores[i] = VALUE_NONE;
+                ++rejected;
+                continue;
+            }
+
+            nnue::FeatureSet& fs = features[n];
+            fs.clear();
+            bool lone_king[COLOR_NB] = {true, true};
+            Bitboard occ = positions[i].occupied;
+            while (occ) {
+                Square sq = pop_lsb(occ);
+                fs.add(pieces[sq], sq);
+                if (piece_type(pieces[sq]) != KING) lone_king[piece_color(pieces[sq])] = false;
+            }
+
+            if (lone_king[WHITE] || lone_king[BLACK]) {
+                unpack_position(positions[i], board);
+                scores[i] = evaluate(board);
+                continue;
+            }
+            stm[n] = Color(positions[i].side);
+            index[n++] = i;
+        }
+
+        nnue::evaluate_batch(features.data(), stm.data(), n, out.data());
+        for (size_t j = 0; j < n; ++j) scores[index[j]] = out[j];
+    }
+    return rejected;
+}
+
+void evaluate_batch(const Board* boards, size_t count, int* scores, int threads) {
+    run_batch(count, scores, threads, [&](size_t i, Board&) { return &boards[i]; });
+}
+
+size_t evaluate_batch(const PackedPosition* positions, size_t count, int* scores, int threads) {
+    if (nnue::enabled()) {
+        return split_blocks(count, threads, [&](size_t begin, size_t end) {
+            return nnue_batch(positions, begin, end, scores);
+        });
+    }
+    return run_batch(count, scores, threads, [&](size_t i, Board& board) {
+        return unpack_position(positions[i], board) ? &board : nullptr;
+    });
+}
+
+void evaluate_batch(const std::string* fens, size_t count, int* scores, int threads) {
+    run_batch(count, scores, threads, [&](size_t i, Board& board) {
+        board.set_fen(fens[i]);
+        return &board;
+    });
+}
+
+bool evaluate_batch_file(const std::string& path, std::vector<int>& scores, size_t& rejected, int threads) {
+    bool binary = path.size() > 4 && path.substr(path.size() - 4) == ".bin";
+    rejected = 0;
+
+    if (binary) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) return false;
+        size_t n = size_t(in.tellg()) / sizeof(PackedPosition);
+        std::vector<PackedPosition> raw(n);
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(raw.data()), n * sizeof(PackedPosition));
+        scores.assign(n, 0);
+        rejected = evaluate_batch(raw.data(), n, scores.data(), threads);
+        if (rejected) std::erase(scores, VALUE_NONE);
+        return true;
+    }
+
+    std::ifstream in(path);
+    if (!in) return false;
+    std::vector<std::string> fens;
+    std::string line, fen;
+    int score, result;
+    while (std::getline(in, line)) {
+        if (parse_scored_line(line, fen, score, result)) fens.push_back(fen);
+        else if (line.find('/') != std::string::npos) fens.push_back(line);
+    }
+    scores.assign(fens.size(), 0);
+    evaluate_batch(fens.data(), fens.size(), scores.data(), threads);
+    return true;
+}
+
+} // namespace chess
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "board.hpp"
+#include "packed.hpp"
+#include <string>
+#include <vector>
+
+namespace chess {
+
+// ============================================================
+// Batch static evaluation for offline scoring.
+// Scores are from the side to move's point of view, exactly as
+// evaluate() would return them. Positions are split into
+// contiguous blocks over 'threads' workers (0 = all cores).
+//
+// With NNUE enabled, packed records take a structure-of-arrays path
+// (nnue::evaluate_batch): they are decoded straight into feature sets
+// without a Board, and each accumulator is updated from the previous
+// position's. Records stored in game order evaluate about 3x faster
+// per core than a loop over evaluate(); shuffled ones gain little.
+// Everything else only adds threading. The classical evaluation
+// branches per piece and per ending, so it is not vectorised across
+// positions, and one thread evaluates no faster than a plain loop.
+// ============================================================
+void evaluate_batch(const Board* boards, size_t count, int* scores, int threads = 0);
+void evaluate_batch(const std::string* fens, size_t count, int* scores, int threads = 0);
+
+// Records unpack_position() rejects score VALUE_NONE; returns their number
+size_t evaluate_batch(const PackedPosition* positions, size_t count, int* scores, int threads = 0);
+
+// Evaluate every position in a file: PackedPosition records if the
+// name ends in .bin, otherwise one FEN or "FEN | score | result" per
+// line. Invalid records are left out of 'scores' and counted in
+// 'rejected'. Returns false if the file cannot be read.
+bool evaluate_batch_file(const std::string& path, std::vector<int>& scores, size_t& rejected, int threads = 0);
+
+} // namespace chess
@@ -4,9 +4,17 @@
 
 #include "types.hpp"
 #include "attacks.hpp"
+#include "bitbase.hpp"
 #include "board.hpp"
+#include "evalbatch.hpp"
 #include "movegen.hpp"
+#include "nnue.hpp"
 #include "search.hpp"
+#include "tbprobe.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -77,6 +85,74 @@ static void uci_position(std::istringstream& iss) {
     }
 }
 
+// Parse a spin option's value, clamped to its advertised range. False
+// (and the option left alone) if it is not a number.
+static bool parse_spin(const std::string& value, int lo, int hi, int& out) {
+    long long v = 0;
+    auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), v);
+    if (ec == std::errc::result_out_of_range) v = value[0] == '-' ? lo : hi;
+    else if (ec != std::errc() || end != value.data() + value.size()) return false;
+    out = int(std::clamp<long long>(v, lo, hi));
+    return true;
+}
+
+// Handle "setoption name <id> [value <x>]" command
+static void uci_setoption(std::istringstream& iss) {
+    std::string token, name, value;
+    iss >> token; // "name"
+    while (iss >> token && token != "value") {
+        if (!name.empty()) name += ' ';
+        name += token;
+    }
+    while (iss >> token) {
+        if (!value.empty()) value += ' ';
+        value += token;
+    }
+
+    int spin = 0;
+    if ((name == "Hash" && !parse_spin(value, 1, 65536, spin))
+        || (name == "EvalCache" && !parse_spin(value, 1, 256, spin))
+        || (name == "Threads" && !parse_spin(value, 1, 256, spin))) {
+        std::cout << "info string invalid value for " << name << ": " << value << std::endl;
+        return;
+    }
+
+    if (name == "Hash") {
+        g_searcher.set_hash_size(spin);
+        std::cout << "info string Hash " << g_searcher.hash_size_mb() << " MB, "
+                  << g_searcher.hash_page_mode() << std::endl;
+    } else if (name == "SharedHash") {
+        if (value == "<empty>") value.clear();
+        if (!g_searcher.set_shared_hash(value))
+            std::cout << "info string cannot share hash as " << value << std::endl;
+        std::cout << "info string Hash " << g_searcher.hash_size_mb() << " MB, "
+                  << g_searcher.hash_page_mode() << std::endl;
+    } else if (name == "EvalCache") {
+        g_searcher.set_eval_cache_size(spin);
+    } else if (name == "Threads") {
+        g_searcher.set_threads(spin);
+    } else if (name == "ClearHashOnNewGame") {
+        g_searcher.set_newgame_clear(value == "true");
+    } else if (name == "ABDADA") {
+        g_searcher.set_abdada(value == "true");
+    } else if (name == "UseNNUE") {
+        nnue::set_enabled(value == "true");
+        g_searcher.clear();
+        if (value == "true" && !nnue::network_loaded())
+            std::cout << "info string no network loaded, using classical eval" << std::endl;
+    } else if (name == "EvalFile") {
+        if (nnue::load_network(value))
+            std::cout << "info string loaded " << nnue::network_info() << std::endl;
+        else
+            std::cout << "info string failed to load network " << value << std::endl;
+        g_searcher.clear();
+    } else if (name == "TBPath") {
+        int n = tb::init(value);
+        std::cout << "info string loaded " << n << " tablebases" << std::endl;
+        g_searcher.clear();
+    }
+}
+
 // Handle "go" command
 static void uci_go(std::istringstream& iss) {
     SearchInfo info;
@@ -128,8 +204,10 @@ static void uci_go(std::istringstream& iss) {
         if (info.time_limit_ms < 50) info.time_limit_ms = 50;
     }
 
-    Move best = g_searcher.search(g_board, info);
-    std::cout << "bestmove " << best.to_uci() << std::endl;
+    // Search in the background so the loop can still read stop and quit
+    g_searcher.start(g_board, info, [](Move best) {
+        std::cout << "bestmove " << best.to_uci() << std::endl;
+    });
 }
 
 // ============================================================
@@ -138,6 +216,7 @@ static void uci_go(std::istringstream& iss) {
 int main() {
     // Initialize attack tables
     init_attacks();
+    init_bitbases();
 
     std::cout << "============================================" << std::endl;
     std::cout << "   Nova 1.2 - Advanced Chess Engine" << std::endl;
@@ -156,14 +235,33 @@ int main() {
         if (cmd == "uci") {
             std::cout << "id name Nova 1.2" << std::endl;
             std::cout << "id author JoshK & Antigravity" << std::endl;
+            std::cout << "option name Hash type spin default 16 min 1 max 65536" << std::endl;
+            std::cout << "option name SharedHash type string default <empty>" << std::endl;
+            std::cout << "option name EvalCache type spin default 4 min 1 max 256" << std::endl;
+            std::cout << "option name Threads type spin default 1 min 1 max 256" << std::endl;
+            std::cout << "option name ClearHashOnNewGame type check default true" << std::endl;
+            std::cout << "option name ABDADA type check default false" << std::endl;
+            std::cout << "option name UseNNUE type check default false" << std::endl;
+            std::cout << "option name EvalFile type string default <empty>" << std::endl;
+            std::cout << "option name TBPath type string default <empty>" << std::endl;
             std::cout << "uciok" << std::endl;
 
         } else if (cmd == "isready") {
+            // Ends a running search first, so its bestmove comes before readyok
+            g_searcher.stop();
             std::cout << "readyok" << std::endl;
 
+        } else if (cmd == "stop") {
+            g_searcher.stop();
+
         } else if (cmd == "ucinewgame") {
+            g_searcher.wait();
             g_board.set_startpos();
-            g_searcher.clear();
+            g_searcher.new_game();
+
+        } else if (cmd == "setoption") {
+            g_searcher.wait();
+            uci_setoption(iss);
 
         } else if (cmd == "position") {
             uci_position(iss);
@@ -174,10 +272,67 @@ int main() {
         } else if (cmd == "quit") {
             break;
 
+        } else if (cmd == "savehash") {
+            // Write the transposition table to a file
+            std::string path;
+            iss >> path;
+            g_searcher.wait();
+            if (g_searcher.save_hash(path))
+                std::cout << "info string saved " << g_searcher.hash_size_mb() << " MB hash to " << path << std::endl;
+            else
+                std::cout << "info string cannot write " << path << std::endl;
+
+        } else if (cmd == "loadhash") {
+            // Replace the transposition table (and its size) with a saved one
+            std::string path;
+            iss >> path;
+            g_searcher.wait();
+            if (g_searcher.load_hash(path))
+                std::cout << "info string loaded " << g_searcher.hash_size_mb() << " MB hash from " << path << std::endl;
+            else
+                std::cout << "info string cannot load hash from " << path << std::endl;
+
         } else if (cmd == "d") {
             // Debug: print board FEN
             std::cout << g_board.to_fen() << std::endl;
 
+        } else if (cmd == "nnuecheck") {
+            // Debug: verify SIMD kernels and incremental updates against scalar
+            g_searcher.wait();
+            nnue::verify({
+                "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+                "rnbqkb1r/pp1p1ppp/5n2/2pPp3/8/8/PPP1PPPP/RNBQKBNR w KQkq e6 0 4",
+                "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                g_board.to_fen(),
+            });
+
+        } else if (cmd == "evalbatch") {
+            // Offline: static eval of every position in a file, optionally
+            // writing one score per line to an output file
+            std::string path, out_path;
+            iss >> path >> out_path;
+            g_searcher.wait();
+            std::vector<int> scores;
+            size_t rejected = 0;
+            auto start = std::chrono::steady_clock::now();
+            if (!evaluate_batch_file(path, scores, rejected)) {
+                std::cout << "info string cannot read " << path << std::endl;
+                continue;
+            }
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (!out_path.empty()) {
+                std::ofstream out(out_path);
+                for (int v : scores) out << v << '\n';
+            }
+            std::cout << "info string evalbatch " << scores.size() << " positions in " << ms
+                      << " ms including loading (" << scores.size() * 1000 / std::max<long long>(ms, 1)
+                      << " pos/s)" << std::endl;
+            if (rejected)
+                std::cout << "info string evalbatch skipped " << rejected << " invalid records" << std::endl;
+
         } else if (cmd == "perft") {
             // Debug: count legal moves at current depth
             MoveList moves;
@@ -189,5 +344,7 @@ int main() {
         }
     }
 
+    // quit, or the input closed: end any search still running
+    g_searcher.stop();
     return 0;
 }
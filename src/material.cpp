@@ -0,0 +1,103 @@
+#include "material.hpp"
+#include "eval_params.hpp"
+#include <vector>
+
+namespace chess {
+
+// Phase weights per piece type
+static constexpr int PhaseWeight[PIECE_TYPE_NB] = {
+    0, 0, 1, 1, 2, 4, 0
+};
+
+static constexpr int MATERIAL_TABLE_SIZE = 8192; // power of two
+
+// ============================================================
+// Entry computation
+// ============================================================
+static void compute_entry(const Board& board, MaterialEntry& e) {
+    int count[COLOR_NB][PIECE_TYPE_NB];
+    int npm[COLOR_NB] = {0, 0};
+    for (int c = 0; c < 2; ++c) {
+        for (int pt = PAWN; pt <= KING; ++pt)
+            count[c][pt] = popcount(board.pieces(Color(c), PieceType(pt)));
+        for (int pt = KNIGHT; pt <= QUEEN; ++pt)
+            npm[c] += count[c][pt] * PieceValue[pt];
+    }
+
+    // Game phase
+    e.phase = 0;
+    for (int c = 0; c < 2; ++c)
+        for (int pt = KNIGHT; pt <= QUEEN; ++pt)
+            e.phase += count[c][pt] * PhaseWeight[pt];
+    if (e.phase > TOTAL_PHASE) e.phase = TOTAL_PHASE;
+
+    // Material imbalance
+    e.imbalance = SCORE_ZERO;
+    for (int c = 0; c < 2; ++c) {
+        int sign = c == WHITE ? 1 : -1;
+        if (count[c][BISHOP] >= 2)
+            e.imbalance += sign * params::BishopPair;
+    }
+
+    // Known endings: one side has a lone king
+    for (int c = 0; c < 2; ++c) {
+        Color strong = Color(c);
+        if (npm[~strong] || count[~strong][PAWN]) continue;
+
+        int pawns = count[strong][PAWN];
+        int minors = count[strong][KNIGHT] + count[strong][BISHOP];
+        bool only_minors = !count[strong][ROOK] && !count[strong][QUEEN];
+
+        if (!pawns && only_minors && (minors <= 1 || (count[strong][KNIGHT] == 2 && minors == 2)))
+            e.eval_fn = eval_draw;
+        else if (!pawns && count[strong][KNIGHT] == 1 && count[strong][BISHOP] == 1 && only_minors)
+            e.eval_fn = eval_kbnk;
+        else if (pawns == 1 && !npm[strong])
+            e.eval_fn = eval_kpk;
+        else if (npm[strong] >= PieceValue[ROOK])
+            e.eval_fn = eval_kxk;
+
+        if (e.eval_fn) {
+            e.eval_strong = strong;
+            return;
+        }
+    }
+
+    // Without pawns a small material edge is usually not enough to win
+    for (int c = 0; c < 2; ++c) {
+        Color us = Color(c);
+        if (!count[us][PAWN] && npm[us] - npm[~us] <= PieceValue[BISHOP]) {
+            e.factor[us] = npm[us] < PieceValue[ROOK] ? SCALE_FACTOR_DRAW
+                         : npm[~us] <= PieceValue[BISHOP] ? 4 : 14;
+        }
+    }
+
+    // Bishop endings: drawish when the bishops are of opposite colours
+    bool bishops_only = true;
+    for (int c = 0; c < 2; ++c) {
+        if (count[c][BISHOP] != 1 || npm[c] != PieceValue[BISHOP])
+            bishops_only = false;
+    }
+    if (bishops_only) {
+        e.scale_fn[WHITE] = scale_ocb;
+        e.scale_fn[BLACK] = scale_ocb;
+    }
+}
+
+// ============================================================
+// Table lookup
+// ============================================================
+MaterialEntry* probe_material(const Board& board) {
+    static thread_local std::vector<MaterialEntry> table(MATERIAL_TABLE_SIZE);
+
+    uint64_t key = board.material_key();
+    MaterialEntry& e = table[key & (MATERIAL_TABLE_SIZE - 1)];
+    if (e.key == key && key != 0) return &e;
+
+    e = MaterialEntry{};
+    e.key = key;
+    compute_entry(board, e);
+    return &e;
+}
+
+} // namespace chess
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "board.hpp"
+#include "endgame.hpp"
+
+namespace chess {
+
+constexpr int TOTAL_PHASE = 24; // 4*1(N) + 4*1(B) + 4*2(R) + 2*4(Q)
+
+// ============================================================
+// Material table entry
+// Everything here depends only on the piece counts, so it is
+// computed once per material signature and cached.
+// ============================================================
+struct MaterialEntry {
+    uint64_t     key = 0;
+    int          phase = 0;          // TOTAL_PHASE = opening, 0 = bare kings
+    Score        imbalance = SCORE_ZERO;  // From White's perspective
+
+    // Exact evaluation of a known ending, if any
+    EndgameEval  eval_fn = nullptr;
+    Color        eval_strong = WHITE;
+
+    // Endgame scaling, per side that would be the stronger one
+    EndgameScale scale_fn[COLOR_NB] = {nullptr, nullptr};
+    uint8_t      factor[COLOR_NB] = {SCALE_FACTOR_NORMAL, SCALE_FACTOR_NORMAL};
+
+    bool has_eval() const { return eval_fn != nullptr; }
+    int  evaluate(const Board& board) const { return eval_fn(board, eval_strong); }
+
+    int scale_factor(const Board& board, Color strong) const {
+        if (scale_fn[strong]) {
+            int sf = scale_fn[strong](board, strong);
+            if (sf != SCALE_FACTOR_NONE) return sf;
+        }
+        return factor[strong];
+    }
+};
+
+// Look up (or compute) the material entry for the position.
+// The table is per thread, so the pointer is valid until the next probe
+// from the same thread.
+MaterialEntry* probe_material(const Board& board);
+
+} // namespace chess
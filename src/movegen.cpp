@@ -96,26 +96,23 @@ static void generate_piece_moves(const Board& board, MoveList& list, PieceType p
     }
 }
 
-static void generate_castling_moves(const Board& board, MoveList& list) {
+static void generate_castling_moves(const Board& board, const AttackInfo& ai, MoveList& list) {
     Color us = board.side_to_move();
     Bitboard occ = board.occupied();
+    Bitboard attacked = ai.attacks(~us);
 
     if (us == WHITE) {
         // King side:  e1 -> g1
         if ((board.castling_rights() & WHITE_OO) &&
             !(occ & (square_bb(SQ_F1) | square_bb(SQ_G1))) &&
-            !board.is_square_attacked(SQ_E1, BLACK) &&
-            !board.is_square_attacked(SQ_F1, BLACK) &&
-            !board.is_square_attacked(SQ_G1, BLACK))
+            !(attacked & (square_bb(SQ_E1) | square_bb(SQ_F1) | square_bb(SQ_G1))))
         {
             list.push(Move(SQ_E1, SQ_G1, MT_CASTLING));
         }
         // Queen side: e1 -> c1
         if ((board.castling_rights() & WHITE_OOO) &&
             !(occ & (square_bb(SQ_D1) | square_bb(SQ_C1) | square_bb(SQ_B1))) &&
-            !board.is_square_attacked(SQ_E1, BLACK) &&
-            !board.is_square_attacked(SQ_D1, BLACK) &&
-            !board.is_square_attacked(SQ_C1, BLACK))
+            !(attacked & (square_bb(SQ_E1) | square_bb(SQ_D1) | square_bb(SQ_C1))))
         {
             list.push(Move(SQ_E1, SQ_C1, MT_CASTLING));
         }
@@ -123,29 +120,66 @@ static void generate_castling_moves(const Board& board, MoveList& list) {
         // King side:  e8 -> g8
         if ((board.castling_rights() & BLACK_OO) &&
             !(occ & (square_bb(SQ_F8) | square_bb(SQ_G8))) &&
-            !board.is_square_attacked(SQ_E8, WHITE) &&
-            !board.is_square_attacked(SQ_F8, WHITE) &&
-            !board.is_square_attacked(SQ_G8, WHITE))
+            !(attacked & (square_bb(SQ_E8) | square_bb(SQ_F8) | square_bb(SQ_G8))))
         {
             list.push(Move(SQ_E8, SQ_G8, MT_CASTLING));
         }
         // Queen side: e8 -> c8
         if ((board.castling_rights() & BLACK_OOO) &&
             !(occ & (square_bb(SQ_D8) | square_bb(SQ_C8) | square_bb(SQ_B8))) &&
-            !board.is_square_attacked(SQ_E8, WHITE) &&
-            !board.is_square_attacked(SQ_D8, WHITE) &&
-            !board.is_square_attacked(SQ_C8, WHITE))
+            !(attacked & (square_bb(SQ_E8) | square_bb(SQ_D8) | square_bb(SQ_C8))))
         {
             list.push(Move(SQ_E8, SQ_C8, MT_CASTLING));
         }
     }
 }
 
+// ============================================================
+// Legality of a pseudo-legal move from pins and checkers
+// ============================================================
+static bool is_legal(const Board& board, const AttackInfo& ai, Move m) {
+    Color us = board.side_to_move();
+    Square ksq = board.king_sq(us);
+    Square from = m.from(), to = m.to();
+
+    // En passant removes two pieces from a line; just try it
+    if (m.is_en_passant()) {
+        Board temp = board;
+        temp.make_move(m);
+        return !temp.is_square_attacked(temp.king_sq(us), ~us);
+    }
+
+    // Castling is only generated when the king's path is safe
+    if (from == ksq)
+        return m.is_castling() || !(ai.king_unsafe & square_bb(to));
+
+    // In check: capture the checker or block, never against a double check
+    if (ai.checkers) {
+        if (more_than_one(ai.checkers)) return false;
+        Square checker = lsb(ai.checkers);
+        if (!((BetweenBB[ksq][checker] | ai.checkers) & square_bb(to))) return false;
+    }
+
+    // A pinned piece may only move along the pin line
+    return !(ai.pinned[us] & square_bb(from)) || (LineBB[from][ksq] & square_bb(to));
+}
+
+static void filter_legal(const Board& board, const AttackInfo& ai, MoveList& list) {
+    int n = 0;
+    for (int i = 0; i < list.count; ++i)
+        if (is_legal(board, ai, list[i])) list.moves[n++] = list[i];
+    list.count = n;
+}
+
 // ============================================================
 // Public API
 // ============================================================
 
 void generate_moves(const Board& board, MoveList& list) {
+    generate_moves(board, AttackInfo(board), list);
+}
+
+void generate_moves(const Board& board, const AttackInfo& ai, MoveList& list) {
     list.count = 0;
 
     generate_pawn_moves(board, list, false);
@@ -154,27 +188,16 @@ void generate_moves(const Board& board, MoveList& list) {
     generate_piece_moves(board, list, ROOK, false);
     generate_piece_moves(board, list, QUEEN, false);
     generate_piece_moves(board, list, KING, false);
-    generate_castling_moves(board, list);
-
-    // Filter to legal moves: make move, check if own king is attacked, unmake
-    Board temp = board;  // copy board for legality testing
-    MoveList legal;
-    legal.count = 0;
-
-    for (int i = 0; i < list.count; ++i) {
-        Move m = list[i];
-        temp = board;
-        temp.make_move(m);
-        // After make_move, side has flipped, so the king we need to check is ~temp.side_to_move()
-        if (!temp.is_square_attacked(temp.king_sq(~temp.side_to_move()), temp.side_to_move())) {
-            legal.push(m);
-        }
-    }
+    generate_castling_moves(board, ai, list);
 
-    list = legal;
+    filter_legal(board, ai, list);
 }
 
 void generate_captures(const Board& board, MoveList& list) {
+    generate_captures(board, AttackInfo(board), list);
+}
+
+void generate_captures(const Board& board, const AttackInfo& ai, MoveList& list) {
     list.count = 0;
 
     generate_pawn_moves(board, list, true);
@@ -184,21 +207,7 @@ void generate_captures(const Board& board, MoveList& list) {
     generate_piece_moves(board, list, QUEEN, true);
     generate_piece_moves(board, list, KING, true);
 
-    // Filter to legal
-    Board temp = board;
-    MoveList legal;
-    legal.count = 0;
-
-    for (int i = 0; i < list.count; ++i) {
-        Move m = list[i];
-        temp = board;
-        temp.make_move(m);
-        if (!temp.is_square_attacked(temp.king_sq(~temp.side_to_move()), temp.side_to_move())) {
-            legal.push(m);
-        }
-    }
-
-    list = legal;
+    filter_legal(board, ai, list);
 }
 
 } // namespace chess
@@ -1,13 +1,16 @@
 #pragma once
 
+#include "attackinfo.hpp"
 #include "board.hpp"
 
 namespace chess {
 
 // Generate all pseudo-legal moves, then filter to legal ones
 void generate_moves(const Board& board, MoveList& list);
+void generate_moves(const Board& board, const AttackInfo& ai, MoveList& list);
 
 // Generate only capture moves (for quiescence search)
 void generate_captures(const Board& board, MoveList& list);
+void generate_captures(const Board& board, const AttackInfo& ai, MoveList& list);
 
 } // namespace chess
@@ -0,0 +1,468 @@
+#include "nnue.hpp"
+#include "board.hpp"
+#include "movegen.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+namespace chess::nnue {
+
+// ============================================================
+// Network parameters
+// ============================================================
+struct Network {
+    int l1 = 0;
+    alignas(64) int16_t ft_weights[INPUTS * MAX_L1];
+    alignas(64) int16_t ft_bias[MAX_L1];
+    alignas(64) int8_t  out_weights[2 * MAX_L1];
+    int32_t out_bias = 0;
+};
+
+static Network g_net;
+static bool g_loaded = false;
+static bool g_enabled = false;
+static std::string g_net_path;
+
+enum class Kernel { Scalar, SSE41, AVX2 };
+
+#if defined(__AVX2__)
+static constexpr Kernel BEST_KERNEL = Kernel::AVX2;
+#elif defined(__SSE4_1__)
+static constexpr Kernel BEST_KERNEL = Kernel::SSE41;
+#else
+static constexpr Kernel BEST_KERNEL = Kernel::Scalar;
+#endif
+
+static const char* kernel_name(Kernel k) {
+    switch (k) {
+        case Kernel::AVX2:  return "avx2";
+        case Kernel::SSE41: return "sse4.1";
+        default:            return "scalar";
+    }
+}
+
+static const int16_t* ft_column(int feature) {
+    return g_net.ft_weights + size_t(feature) * g_net.l1;
+}
+
+// ============================================================
+// Accumulator update kernels: out = in + sum(adds) - sum(subs)
+// ============================================================
+static void update_scalar(int16_t* out, const int16_t* in,
+                          const int16_t* const* adds, int n_add,
+                          const int16_t* const* subs, int n_sub, int l1) {
+    for (int i = 0; i < l1; ++i) {
+        int16_t v = in[i];
+        for (int a = 0; a < n_add; ++a) v += adds[a][i];
+        for (int s = 0; s < n_sub; ++s) v -= subs[s][i];
+        out[i] = v;
+    }
+}
+
+#if defined(__SSE4_1__) || defined(__AVX2__)
+static void update_sse41(int16_t* out, const int16_t* in,
+                         const int16_t* const* adds, int n_add,
+                         const int16_t* const* subs, int n_sub, int l1) {
+    for (int i = 0; i < l1; i += 8) {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(in + i));
+        for (int a = 0; a < n_add; ++a)
+            v = _mm_add_epi16(v, _mm_load_si128(reinterpret_cast<const __m128i*>(adds[a] + i)));
+        for (int s = 0; s < n_sub; ++s)
+            v = _mm_sub_epi16(v, _mm_load_si128(reinterpret_cast<const __m128i*>(subs[s] + i)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(out + i), v);
+    }
+}
+#endif
+
+#if defined(__AVX2__)
+static void update_avx2(int16_t* out, const int16_t* in,
+                        const int16_t* const* adds, int n_add,
+                        const int16_t* const* subs, int n_sub, int l1) {
+    for (int i = 0; i < l1; i += 16) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(in + i));
+        for (int a = 0; a < n_add; ++a)
+            v = _mm256_add_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(adds[a] + i)));
+        for (int s = 0; s < n_sub; ++s)
+            v = _mm256_sub_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(subs[s] + i)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+}
+#endif
+
+static void update(Kernel k, int16_t* out, const int16_t* in,
+                   const int16_t* const* adds, int n_add,
+                   const int16_t* const* subs, int n_sub) {
+    switch (k) {
+#if defined(__AVX2__)
+        case Kernel::AVX2:  update_avx2(out, in, adds, n_add, subs, n_sub, g_net.l1); return;
+#endif
+#if defined(__SSE4_1__) || defined(__AVX2__)
+        case Kernel::SSE41: update_sse41(out, in, adds, n_add, subs, n_sub, g_net.l1); return;
+#endif
+        default:            update_scalar(out, in, adds, n_add, subs, n_sub, g_net.l1); return;
+    }
+}
+
+// ============================================================
+// Output kernels: sum(clamp(acc, 0, QA) * w) over one perspective
+// ============================================================
+static int32_t output_scalar(const int16_t* acc, const int8_t* w, int l1) {
+    int32_t sum = 0;
+    for (int i = 0; i < l1; ++i) {
+        int v = acc[i] < 0 ? 0 : acc[i] > QA ? QA : acc[i];
+        sum += v * w[i];
+    }
+    return sum;
+}
+
+#if defined(__SSE4_1__) || defined(__AVX2__)
+static int32_t output_sse41(const int16_t* acc, const int8_t* w, int l1) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i qa = _mm_set1_epi16(QA);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < l1; i += 16) {
+        __m128i a0 = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i a1 = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i + 8));
+        a0 = _mm_min_epi16(_mm_max_epi16(a0, zero), qa);
+        a1 = _mm_min_epi16(_mm_max_epi16(a1, zero), qa);
+        __m128i act = _mm_packus_epi16(a0, a1);
+        __m128i wv = _mm_load_si128(reinterpret_cast<const __m128i*>(w + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(act, wv), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+#if defined(__AVX2__)
+static int32_t output_avx2(const int16_t* acc, const int8_t* w, int l1) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i qa = _mm256_set1_epi16(QA);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < l1; i += 32) {
+        __m256i a0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i a1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i + 16));
+        a0 = _mm256_min_epi16(_mm256_max_epi16(a0, zero), qa);
+        a1 = _mm256_min_epi16(_mm256_max_epi16(a1, zero), qa);
+        // packus works per 128-bit lane; restore the element order
+        __m256i act = _mm256_permute4x64_epi64(_mm256_packus_epi16(a0, a1), 0xD8);
+        __m256i wv = _mm256_load_si256(reinterpret_cast<const __m256i*>(w + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(act, wv), ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+#endif
+
+static int32_t output(Kernel k, const int16_t* acc, const int8_t* w) {
+    switch (k) {
+#if defined(__AVX2__)
+        case Kernel::AVX2:  return output_avx2(acc, w, g_net.l1);
+#endif
+#if defined(__SSE4_1__) || defined(__AVX2__)
+        case Kernel::SSE41: return output_sse41(acc, w, g_net.l1);
+#endif
+        default:            return output_scalar(acc, w, g_net.l1);
+    }
+}
+
+static bool same_values(const Accumulator& a, const Accumulator& b) {
+    for (int c = 0; c < 2; ++c)
+        if (std::memcmp(a.values[c], b.values[c], sizeof(int16_t) * g_net.l1) != 0)
+            return false;
+    return true;
+}
+
+static int forward(Kernel k, const Accumulator& acc, Color stm) {
+    int32_t sum = g_net.out_bias
+                + output(k, acc.values[stm], g_net.out_weights)
+                + output(k, acc.values[~stm], g_net.out_weights + g_net.l1);
+    return int(int64_t(sum) * OUTPUT_SCALE / (QA * QB));
+}
+
+// ============================================================
+// Accumulator stack
+// ============================================================
+static void refresh_accumulator(Kernel k, const Board& board, Accumulator& acc) {
+    for (int c = 0; c < 2; ++c) {
+        Color perspective = Color(c);
+        std::memcpy(acc.values[c], g_net.ft_bias, sizeof(int16_t) * g_net.l1);
+
+        // Add the active features in batches of four columns
+        const int16_t* cols[4];
+        int n = 0;
+        Bitboard occ = board.occupied();
+        while (occ) {
+            Square sq = pop_lsb(occ);
+            cols[n++] = ft_column(feature_index(perspective, board.piece_on(sq), sq));
+            if (n == 4 || !occ) {
+                update(k, acc.values[c], acc.values[c], cols, n, nullptr, 0);
+                n = 0;
+            }
+        }
+    }
+}
+
+void AccumulatorStack::refresh(const Board& board) {
+    top_ = 0;
+    if (g_loaded) refresh_accumulator(BEST_KERNEL, board, stack_[0]);
+}
+
+void AccumulatorStack::push(const DirtyPieces& dirty) {
+    if (top_ + 1 == stack_.size()) stack_.resize(stack_.size() * 2);
+    const Accumulator& prev = stack_[top_];
+    Accumulator& next = stack_[++top_];
+    if (!g_loaded) return;
+
+    for (int c = 0; c < 2; ++c) {
+        Color perspective = Color(c);
+        const int16_t* adds[4];
+        const int16_t* subs[4];
+        for (int i = 0; i < dirty.n_add; ++i)
+            adds[i] = ft_column(feature_index(perspective, dirty.add_piece[i], dirty.add_sq[i]));
+        for (int i = 0; i < dirty.n_rem; ++i)
+            subs[i] = ft_column(feature_index(perspective, dirty.rem_piece[i], dirty.rem_sq[i]));
+        update(BEST_KERNEL, next.values[c], prev.values[c], adds, dirty.n_add, subs, dirty.n_rem);
+    }
+}
+
+void AccumulatorStack::push_copy() {
+    if (top_ + 1 == stack_.size()) stack_.resize(stack_.size() * 2);
+    ++top_;
+    std::memcpy(&stack_[top_], &stack_[top_ - 1], sizeof(Accumulator));
+}
+
+// ============================================================
+// Loading
+// ============================================================
+
+// The file is read into a scratch network and only then copied over the
+// active one, so a failed load leaves the previous network in use
+bool load_network(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[8];
+    uint32_t version = 0, l1 = 0;
+    in.read(magic, 8);
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&l1), sizeof(l1));
+    if (!in || std::memcmp(magic, "NOVANNUE", 8) != 0 || version != NET_VERSION
+        || l1 == 0 || l1 > uint32_t(MAX_L1) || l1 % 32 != 0)
+        return false;
+
+    auto net = std::make_unique<Network>();
+    net->l1 = int(l1);
+    in.read(reinterpret_cast<char*>(net->ft_weights), sizeof(int16_t) * INPUTS * l1);
+    in.read(reinterpret_cast<char*>(net->ft_bias), sizeof(int16_t) * l1);
+    in.read(reinterpret_cast<char*>(net->out_weights), sizeof(int8_t) * 2 * l1);
+    in.read(reinterpret_cast<char*>(&net->out_bias), sizeof(int32_t));
+    if (!in) return false;
+
+    g_net = *net;
+    g_loaded = true;
+    g_net_path = path;
+    return true;
+}
+
+bool save_network(const std::string& path, int l1,
+                  const int16_t* ft_weights, const int16_t* ft_bias,
+                  const int8_t* out_weights, int32_t out_bias) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    uint32_t version = NET_VERSION, size = uint32_t(l1);
+    out.write("NOVANNUE", 8);
+    out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    out.write(reinterpret_cast<const char*>(ft_weights), sizeof(int16_t) * INPUTS * l1);
+    out.write(reinterpret_cast<const char*>(ft_bias), sizeof(int16_t) * l1);
+    out.write(reinterpret_cast<const char*>(out_weights), sizeof(int8_t) * 2 * l1);
+    out.write(reinterpret_cast<const char*>(&out_bias), sizeof(int32_t));
+    return bool(out);
+}
+
+bool network_loaded() { return g_loaded; }
+
+std::string network_info() {
+    if (!g_loaded) return "no network loaded";
+    return g_net_path + " (768x" + std::to_string(g_net.l1) + "x2x1, "
+         + kernel_name(BEST_KERNEL) + " kernels)";
+}
+
+void set_enabled(bool on) { g_enabled = on; }
+bool enabled() { return g_enabled && g_loaded; }
+
+// ============================================================
+// Evaluation
+// ============================================================
+int evaluate(const Board& board) {
+    if (const AccumulatorStack* stack = board.accumulators())
+        return forward(BEST_KERNEL, stack->top(), board.side_to_move());
+
+    static thread_local Accumulator acc;
+    refresh_accumulator(BEST_KERNEL, board, acc);
+    return forward(BEST_KERNEL, acc, board.side_to_move());
+}
+
+// ============================================================
+// Batch evaluation
+// ============================================================
+
+// A White-perspective feature seen from Black: colours swap, ranks flip
+static int mirror_feature(int f) {
+    return (f ^ 56) + (f < 384 ? 384 : -384);
+}
+
+// Add the columns of the features in 'add' and subtract those in 'sub'
+// (if any), four at a time per perspective
+static void apply_features(Kernel k, Accumulator& acc, const uint64_t* add, const uint64_t* sub) {
+    for (int c = 0; c < 2; ++c) {
+        const int16_t* adds[4];
+        const int16_t* subs[4];
+        int n_add = 0, n_sub = 0;
+        for (int w = 0; w < FEATURE_WORDS; ++w) {
+            Bitboard a = add[w], s = sub ? sub[w] : 0;
+            while (a || s) {
+                if (a) {
+                    int f = w * 64 + pop_lsb(a);
+                    adds[n_add++] = ft_column(c == WHITE ? f : mirror_feature(f));
+                }
+                if (s) {
+                    int f = w * 64 + pop_lsb(s);
+                    subs[n_sub++] = ft_column(c == WHITE ? f : mirror_feature(f));
+                }
+                if (n_add == 4 || n_sub == 4) {
+                    update(k, acc.values[c], acc.values[c], adds, n_add, subs, n_sub);
+                    n_add = n_sub = 0;
+                }
+            }
+        }
+        if (n_add || n_sub) update(k, acc.values[c], acc.values[c], adds, n_add, subs, n_sub);
+    }
+}
+
+static void evaluate_batch(Kernel k, const FeatureSet* features, const Color* stm, size_t count, int* scores) {
+    static thread_local Accumulator acc;
+    for (size_t i = 0; i < count; ++i) {
+        const FeatureSet& cur = features[i];
+
+        // Each changed feature costs one column, a refresh one per piece
+        uint64_t add[FEATURE_WORDS], sub[FEATURE_WORDS];
+        int changed = 0, active = 0;
+        for (int w = 0; w < FEATURE_WORDS && i > 0; ++w) {
+            add[w] = cur.bits[w] & ~features[i - 1].bits[w];
+            sub[w] = features[i - 1].bits[w] & ~cur.bits[w];
+            changed += popcount(add[w] | sub[w]);
+            active += popcount(cur.bits[w]);
+        }
+
+        if (i > 0 && changed < active) {
+            apply_features(k, acc, add, sub);
+        } else {
+            for (int c = 0; c < 2; ++c)
+                std::memcpy(acc.values[c], g_net.ft_bias, sizeof(int16_t) * g_net.l1);
+            apply_features(k, acc, cur.bits, nullptr);
+        }
+        scores[i] = forward(k, acc, stm[i]);
+    }
+}
+
+void evaluate_batch(const FeatureSet* features, const Color* stm, size_t count, int* scores) {
+    evaluate_batch(BEST_KERNEL, features, stm, count, scores);
+}
+
+bool verify(const std::vector<std::string>& fens) {
+    if (!g_loaded) {
+        std::cout << "info string nnue verify: no network loaded" << std::endl;
+        return false;
+    }
+
+    Kernel kernels[] = {Kernel::Scalar, Kernel::SSE41, Kernel::AVX2};
+    int compiled = BEST_KERNEL == Kernel::AVX2 ? 3 : BEST_KERNEL == Kernel::SSE41 ? 2 : 1;
+    bool ok = true;
+    AccumulatorStack stack;
+    static Accumulator reference, acc;
+    // Every position visited, for the batch evaluation check
+    std::vector<FeatureSet> features;
+    std::vector<Color> stm;
+    std::vector<int> expected_scores;
+    auto collect = [&](const Board& board, int expected) {
+        FeatureSet fs;
+        fs.clear();
+        for (Bitboard occ = board.occupied(); occ; ) {
+            Square sq = pop_lsb(occ);
+            fs.add(board.piece_on(sq), sq);
+        }
+        features.push_back(fs);
+        stm.push_back(board.side_to_move());
+        expected_scores.push_back(expected);
+    };
+
+    for (const auto& fen : fens) {
+        Board board;
+        board.set_fen(fen);
+
+        // All kernels must agree exactly on a full refresh
+        refresh_accumulator(Kernel::Scalar, board, reference);
+        int expected = forward(Kernel::Scalar, reference, board.side_to_move());
+        collect(board, expected);
+        for (int i = 1; i < compiled; ++i) {
+            refresh_accumulator(kernels[i], board, acc);
+            int got = forward(kernels[i], acc, board.side_to_move());
+            if (got != expected || !same_values(acc, reference)) {
+                std::cout << "info string nnue verify: " << kernel_name(kernels[i])
+                          << " mismatch (" << got << " vs " << expected << ") in " << fen << std::endl;
+                ok = false;
+            }
+        }
+
+        // Incremental updates after every legal move must match a refresh
+        board.attach_accumulators(&stack);
+        MoveList moves;
+        generate_moves(board, moves);
+        for (Move m : moves) {
+            board.make_move(m);
+            refresh_accumulator(Kernel::Scalar, board, reference);
+            if (!same_values(stack.top(), reference)) {
+                std::cout << "info string nnue verify: incremental mismatch after "
+                          << m.to_uci() << " in " << fen << std::endl;
+                ok = false;
+            }
+            collect(board, forward(Kernel::Scalar, reference, board.side_to_move()));
+            board.unmake_move(m);
+        }
+        board.attach_accumulators(nullptr);
+    }
+
+    // Batch evaluation, refreshing or updating from the previous position,
+    // must give the same scores
+    std::vector<int> scores(features.size());
+    for (int i = 0; i < compiled; ++i) {
+        evaluate_batch(kernels[i], features.data(), stm.data(), features.size(), scores.data());
+        if (scores != expected_scores) {
+            std::cout << "info string nnue verify: " << kernel_name(kernels[i])
+                      << " batch evaluation mismatch" << std::endl;
+            ok = false;
+        }
+    }
+
+    std::cout << "info string nnue verify: " << fens.size() << " positions, kernels";
+    for (int i = 0; i < compiled; ++i) std::cout << ' ' << kernel_name(kernels[i]);
+    std::cout << (ok ? ", all outputs match" : ", MISMATCH") << std::endl;
+    return ok;
+}
+
+} // namespace chess::nnue
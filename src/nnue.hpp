@@ -0,0 +1,130 @@
+#pragma once
+
+#include "types.hpp"
+#include <string>
+#include <vector>
+
+namespace chess {
+
+class Board;
+
+namespace nnue {
+
+// ============================================================
+// Network layout: (768 -> L1) x 2 perspectives -> 1
+//
+// File format (little endian):
+//   char     magic[8]    "NOVANNUE"
+//   uint32   version     NET_VERSION
+//   uint32   l1          hidden size, multiple of 32, <= MAX_L1
+//   int16    ft_weights  [768][l1]  feature-major
+//   int16    ft_bias     [l1]
+//   int8     out_weights [2][l1]    side to move first
+//   int32    out_bias
+// ============================================================
+constexpr uint32_t NET_VERSION = 1;
+constexpr int INPUTS = 768;     // 2 colours x 6 piece types x 64 squares
+constexpr int MAX_L1 = 512;
+
+// Quantization: accumulator activations are clipped to [0, QA] so they
+// fit in uint8, output weights are int8 scaled by QB.
+constexpr int QA = 127;
+constexpr int QB = 64;
+constexpr int OUTPUT_SCALE = 400;
+
+// Feature index of a piece on a square, seen from 'perspective'
+inline int feature_index(Color perspective, Piece p, Square sq) {
+    Color c = piece_color(p);
+    if (perspective == BLACK) {
+        c = ~c;
+        sq = Square(sq ^ 56);
+    }
+    return (c * 6 + piece_type(p) - 1) * 64 + sq;
+}
+
+// ============================================================
+// Accumulators
+// ============================================================
+struct alignas(64) Accumulator {
+    int16_t values[COLOR_NB][MAX_L1];
+};
+
+// Feature changes made by a single move
+struct DirtyPieces {
+    Piece add_piece[4];
+    Square add_sq[4];
+    Piece rem_piece[4];
+    Square rem_sq[4];
+    int n_add = 0;
+    int n_rem = 0;
+
+    void add(Piece p, Square sq)    { add_piece[n_add] = p; add_sq[n_add++] = sq; }
+    void remove(Piece p, Square sq) { rem_piece[n_rem] = p; rem_sq[n_rem++] = sq; }
+    void move(Piece p, Square from, Square to) { remove(p, from); add(p, to); }
+};
+
+// Accumulators along the current search line, one per ply
+class AccumulatorStack {
+public:
+    AccumulatorStack() : stack_(256) {}
+
+    void refresh(const Board& board);
+    void push(const DirtyPieces& dirty);
+    void push_copy();
+    void pop() { --top_; }
+
+    const Accumulator& top() const { return stack_[top_]; }
+
+private:
+    std::vector<Accumulator> stack_;
+    size_t top_ = 0;
+};
+
+// ============================================================
+// Network loading and evaluation
+// ============================================================
+bool load_network(const std::string& path);
+bool save_network(const std::string& path, int l1,
+                  const int16_t* ft_weights, const int16_t* ft_bias,
+                  const int8_t* out_weights, int32_t out_bias);
+bool network_loaded();
+std::string network_info();
+
+// NNUE is used by evaluate() when enabled and a network is loaded
+void set_enabled(bool on);
+bool enabled();
+
+// Evaluate from the side to move's point of view. Uses the board's
+// attached accumulator stack if any, otherwise refreshes from scratch.
+int evaluate(const Board& board);
+
+// ============================================================
+// Batch evaluation over structure-of-arrays inputs
+//
+// Position i is features[i] (its active features from White's point
+// of view, one bit each) with stm[i] to move. Positions are built
+// without a Board, and each accumulator is derived from the previous
+// position's by the features that differ, unless a refresh is cheaper:
+// consecutive positions from one game differ by a move or two. Scores
+// equal evaluate(); known endings are the caller's to filter out.
+// ============================================================
+constexpr int FEATURE_WORDS = INPUTS / 64;
+
+struct FeatureSet {
+    uint64_t bits[FEATURE_WORDS];
+
+    void clear() { for (auto& w : bits) w = 0; }
+    void add(Piece p, Square sq) {
+        int f = feature_index(WHITE, p, sq);
+        bits[f / 64] |= 1ULL << (f % 64);
+    }
+};
+
+void evaluate_batch(const FeatureSet* features, const Color* stm, size_t count, int* scores);
+
+// Compare every compiled-in inference kernel against the scalar one and
+// the incremental accumulators against a full refresh. Prints a report.
+bool verify(const std::vector<std::string>& fens);
+
+} // namespace nnue
+} // namespace chess
@@ -0,0 +1,82 @@
+#include "packed.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace chess {
+
+PackedPosition pack_position(const Board& board, int score, int result) {
+    PackedPosition p{};
+    p.occupied = board.occupied();
+
+    int i = 0;
+    Bitboard occ = p.occupied;
+    while (occ) {
+        Square sq = pop_lsb(occ);
+        p.pieces[i / 2] |= uint8_t(board.piece_on(sq) << (4 * (i & 1)));
+        ++i;
+    }
+
+    p.score = int16_t(score);
+    p.side = uint8_t(board.side_to_move());
+    p.castling = uint8_t(board.castling_rights());
+    p.ep_square = uint8_t(board.en_passant_sq());
+    p.result = uint8_t(result);
+    p.halfmove = uint8_t(std::min(board.halfmove_clock(), 255));
+    return p;
+}
+
+bool unpack_pieces(const PackedPosition& p, Piece (&pieces)[SQUARE_NB]) {
+    if (popcount(p.occupied) > 32 || p.side > BLACK || p.castling > ALL_CASTLING)
+        return false;
+
+    Square ep = Square(p.ep_square);
+    if (ep != SQ_NONE && (ep > SQ_NONE || rank_of(ep) != (p.side == WHITE ? RANK_6 : RANK_3)))
+        return false;
+
+    for (auto& pc : pieces) pc = NO_PIECE;
+
+    int i = 0, kings[COLOR_NB] = {};
+    Bitboard occ = p.occupied;
+    while (occ) {
+        Square sq = pop_lsb(occ);
+        Piece pc = Piece((p.pieces[i / 2] >> (4 * (i & 1))) & 15);
+        ++i;
+
+        PieceType pt = piece_type(pc);
+        if (pt == NO_PIECE_TYPE || pt > KING) return false;
+        if (pt == PAWN && (rank_of(sq) == RANK_1 || rank_of(sq) == RANK_8)) return false;
+        if (pt == KING) kings[piece_color(pc)]++;
+        pieces[sq] = pc;
+    }
+    return kings[WHITE] == 1 && kings[BLACK] == 1;
+}
+
+bool unpack_position(const PackedPosition& p, Board& board) {
+    Piece pieces[SQUARE_NB];
+    if (!unpack_pieces(p, pieces)) return false;
+
+    board.set_position(pieces, Color(p.side), p.castling, Square(p.ep_square), p.halfmove, 1);
+    return true;
+}
+
+bool parse_scored_line(const std::string& line, std::string& fen, int& score, int& result) {
+    size_t a = line.find('|');
+    if (a == std::string::npos) return false;
+    size_t b = line.find('|', a + 1);
+    if (b == std::string::npos) return false;
+
+    fen = line.substr(0, a);
+    std::istringstream score_ss(line.substr(a + 1, b - a - 1));
+    if (!(score_ss >> score)) return false;
+
+    std::istringstream result_ss(line.substr(b + 1));
+    std::string r;
+    result_ss >> r;
+    if (r == "1.0" || r == "1" || r == "1-0")            result = 2;
+    else if (r == "0.5" || r == "1/2-1/2")               result = 1;
+    else if (r == "0.0" || r == "0" || r == "0-1")       result = 0;
+    else return false;
+    return true;
+}
+
+} // namespace chess
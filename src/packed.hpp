@@ -0,0 +1,45 @@
+#pragma once
+
+#include "board.hpp"
+#include <string>
+
+namespace chess {
+
+// ============================================================
+// Packed training/scoring position (32 bytes)
+//   occupied : one bit per occupied square
+//   pieces   : 4-bit Piece codes in square order of 'occupied'
+//   score    : centipawns, White's point of view
+//   result   : 0 = Black win, 1 = draw, 2 = White win
+// ============================================================
+struct PackedPosition {
+    uint64_t occupied;
+    uint8_t  pieces[16];
+    int16_t  score;
+    uint8_t  side;
+    uint8_t  castling;
+    uint8_t  ep_square;
+    uint8_t  result;
+    uint8_t  halfmove;
+    uint8_t  padding;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must be 32 bytes");
+
+PackedPosition pack_position(const Board& board, int score, int result);
+
+// Set up 'board' from a record. Returns false (board untouched) for a
+// record no legal position packs to: more than 32 pieces, an unknown
+// piece code, side, castling or en passant value, a pawn on the first
+// or last rank, or not exactly one king per side.
+bool unpack_position(const PackedPosition& packed, Board& board);
+
+// The same checks, decoding only the piece placement (A1 = 0)
+bool unpack_pieces(const PackedPosition& packed, Piece (&pieces)[SQUARE_NB]);
+
+// Parse a text line "<FEN> | <score> | <result>" where result is
+// 1.0 / 0.5 / 0.0 (or 1-0 / 1/2-1/2 / 0-1) from White's point of view.
+// Returns false if the line is not in this format.
+bool parse_scored_line(const std::string& line, std::string& fen, int& score, int& result);
+
+} // namespace chess
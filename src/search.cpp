@@ -1,11 +1,15 @@
 #include "search.hpp"
+#include "endgame.hpp"
 #include "eval.hpp"
 #include "movegen.hpp"
 #include "see.hpp"
+#include "tbprobe.hpp"
 #include <algorithm>
 #include <iostream>
 #include <cstring>
 #include <cmath>
+#include <thread>
+#include <unordered_map>
 
 namespace chess {
 
@@ -24,72 +28,212 @@ static constexpr int MVV_LVA[PIECE_TYPE_NB][PIECE_TYPE_NB] = {
     /* KING   */ {0,    0,    0,     0,     0,    0,    0},
 };
 
+// ============================================================
+// LMR table, shared read-only by all threads
+// ============================================================
+static int Reductions[64][64];
+
+static void init_reductions() {
+    for (int d = 0; d < 64; ++d) {
+        for (int c = 0; c < 64; ++c) {
+            if (d == 0 || c == 0) {
+                Reductions[d][c] = 0;
+            } else {
+                Reductions[d][c] = static_cast<int>(0.5 + std::log(d) * std::log(c) / 2.0);
+            }
+        }
+    }
+}
+
 // ============================================================
 // Searcher implementation
 // ============================================================
-Searcher::Searcher() : tt_(TT_SIZE) {
+Searcher::Searcher() : abdada_(new std::atomic<uint64_t>[ABDADA_BUCKETS * ABDADA_WAYS]) {
+    for (int i = 0; i < ABDADA_BUCKETS * ABDADA_WAYS; ++i) abdada_[i] = 0;
     init_reductions();
-    clear();
+    set_threads(1);
+    set_hash_size(16);
 }
 
 void Searcher::clear() {
-    std::fill(tt_.begin(), tt_.end(), TTEntry{});
-    tt_age_ = 0;
-    std::memset(killers_, 0, sizeof(killers_));
-    std::memset(history_, 0, sizeof(history_));
-    std::memset(pv_table_, 0, sizeof(pv_table_));
-    std::memset(pv_length_, 0, sizeof(pv_length_));
-    last_best_move_ = MOVE_NONE;
-    best_move_changes_ = 0;
+    tt_.clear(thread_count());
+    for (auto& t : threads_) t->clear();
+}
+
+void Searcher::new_game() {
+    if (newgame_clear_) {
+        clear();
+        return;
+    }
+    tt_.new_search();
+    for (auto& t : threads_) t->clear();
+}
+
+void Searcher::set_eval_cache_size(int mb) {
+    eval_cache_mb_ = mb;
+    for (auto& t : threads_) t->set_eval_cache_size(mb);
+}
+
+void Searcher::set_threads(int n) {
+    n = std::max(n, 1);
+    while (int(threads_.size()) > n) threads_.pop_back();
+    while (int(threads_.size()) < n) {
+        threads_.push_back(std::make_unique<SearchThread>(*this, int(threads_.size())));
+        threads_.back()->set_eval_cache_size(eval_cache_mb_);
+    }
+}
+
+uint64_t Searcher::nodes_searched() const {
+    uint64_t n = 0;
+    for (auto& t : threads_) n += t->stats.nodes.load(std::memory_order_relaxed);
+    return n;
+}
+
+uint64_t Searcher::tb_hits() const {
+    uint64_t n = 0;
+    for (auto& t : threads_) n += t->stats.tb_hits.load(std::memory_order_relaxed);
+    return n;
 }
 
 // ============================================================
-// TT operations
+// ABDADA: hashes of (position, move) pairs being searched right now,
+// a few ways per bucket. A full bucket simply leaves the move unmarked.
 // ============================================================
-TTEntry* Searcher::probe_tt(uint64_t key) {
-    TTEntry& entry = tt_[key % TT_SIZE];
-    if (entry.key == key) return &entry;
-    return nullptr;
+bool Searcher::abdada_busy(uint64_t move_key) const {
+    const std::atomic<uint64_t>* bucket = &abdada_[(move_key & (ABDADA_BUCKETS - 1)) * ABDADA_WAYS];
+    for (int w = 0; w < ABDADA_WAYS; ++w)
+        if (bucket[w].load(std::memory_order_relaxed) == move_key) return true;
+    return false;
 }
 
-void Searcher::store_tt(uint64_t key, int depth, int score, TTFlag flag, Move best) {
-    TTEntry& entry = tt_[key % TT_SIZE];
-    
-    // Replacement scheme:
-    // 1. Always replace if it's a new position
-    // 2. Replace if the new entry is from a more recent search (aging)
-    // 3. Replace if the new entry search was deeper
-    if (key != entry.key || (tt_age_ != entry.age) || depth >= entry.depth) {
-        entry.key = key;
-        entry.depth = depth;
-        entry.score = score;
-        entry.flag = flag;
-        entry.best_move = best;
-        entry.age = tt_age_;
+void Searcher::abdada_enter(uint64_t move_key) {
+    std::atomic<uint64_t>* bucket = &abdada_[(move_key & (ABDADA_BUCKETS - 1)) * ABDADA_WAYS];
+    for (int w = 0; w < ABDADA_WAYS; ++w) {
+        uint64_t empty = 0;
+        if (bucket[w].compare_exchange_strong(empty, move_key, std::memory_order_relaxed)) return;
     }
 }
 
-void Searcher::init_reductions() {
-    for (int d = 0; d < 64; ++d) {
-        for (int c = 0; c < 64; ++c) {
-            if (d == 0 || c == 0) {
-                reductions_[d][c] = 0;
-            } else {
-                reductions_[d][c] = static_cast<int>(0.5 + std::log(d) * std::log(c) / 2.0);
-            }
-        }
+void Searcher::abdada_leave(uint64_t move_key) {
+    std::atomic<uint64_t>* bucket = &abdada_[(move_key & (ABDADA_BUCKETS - 1)) * ABDADA_WAYS];
+    for (int w = 0; w < ABDADA_WAYS; ++w) {
+        uint64_t mine = move_key;
+        if (bucket[w].compare_exchange_strong(mine, 0, std::memory_order_relaxed)) return;
+    }
+}
+
+// ============================================================
+// Search thread state
+// ============================================================
+SearchThread::SearchThread(Searcher& owner, int id) : owner_(owner), id_(id) {
+    clear();
+}
+
+void SearchThread::clear() {
+    std::fill(eval_cache_.begin(), eval_cache_.end(), EvalCacheEntry{});
+    std::memset(history_, 0, sizeof(history_));
+    std::memset(cont_hist_, 0, sizeof(cont_hist_));
+    std::memset(counter_moves_, 0, sizeof(counter_moves_));
+    for (int i = 0; i < MAX_PLY + STACK_OFFSET + 1; ++i) {
+        stack_[i] = SearchStack{};
+        stack_[i].cont_hist = &cont_hist_[NO_PIECE][0];
+        stack_[i].ply = i - STACK_OFFSET;
+        stack_[i].static_eval = VALUE_NONE;
     }
+    root_pv_[0] = MOVE_NONE;
+    best_pv_length_ = 0;
+    completed_depth_ = 0;
+    last_best_move_ = MOVE_NONE;
+    best_move_changes_ = 0;
+}
+
+// ============================================================
+// Static evaluation cache
+// ============================================================
+void SearchThread::set_eval_cache_size(int mb) {
+    // Round down to a power of two so the index is a simple mask
+    size_t entries = size_t(std::max(mb, 1)) * 1024 * 1024 / sizeof(EvalCacheEntry);
+    size_t size = 1;
+    while (size * 2 <= entries) size *= 2;
+    eval_cache_.assign(size, EvalCacheEntry{});
+}
+
+// Only full evaluations are cached; a lazy score is valid for its window
+// only, and 'lazy' tells the caller which one it got
+int SearchThread::cached_evaluate(const Board& board, std::optional<AttackInfo>& ai, int alpha, int beta, bool& lazy) {
+    uint64_t key = board.hash_key();
+    EvalCacheEntry& entry = eval_cache_[key & (eval_cache_.size() - 1)];
+    uint32_t check = uint32_t(key >> 32);
+    lazy = false;
+    if (entry.key == check) return entry.score;
+
+    int score = evaluate(board, ai, alpha, beta, lazy);
+    if (lazy) return score;
+    entry.key = check;
+    entry.score = score;
+    return score;
 }
 
 // ============================================================
 // Move ordering
 // ============================================================
+
+// pv = m followed by the child's PV
+static void update_pv(Move* pv, Move m, const Move* child) {
+    *pv++ = m;
+    while (*child != MOVE_NONE) *pv++ = *child++;
+    *pv = MOVE_NONE;
+}
+
 struct ScoredMove {
     Move move;
     int  score;
 };
 
-void Searcher::score_moves(const Board& board, MoveList& moves, Move tt_move, int ply) {
+// Quiet moves that save a piece attacked by a cheaper one are tried
+// earlier, and moves that put a piece where a cheaper one can take it later
+static constexpr int ThreatValue[PIECE_TYPE_NB] = {0, 0, 8000, 8000, 12000, 20000, 0};
+
+static int threat_score(const Board& board, const AttackInfo& ai, Move m) {
+    PieceType pt = piece_type(board.piece_on(m.from()));
+    if (ai.danger(pt) & square_bb(m.to())) return -ThreatValue[pt];
+    if (ai.threatened & square_bb(m.from())) return ThreatValue[pt];
+    return 0;
+}
+
+// Gravity update: the step shrinks as the entry nears +-HISTORY_MAX,
+// which bounds it and lets recent results outweigh old ones
+template <typename T>
+static void update_history(T& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+
+static int history_bonus(int depth) {
+    return std::min(16 * depth * depth, 1600);
+}
+
+// Butterfly history plus continuation history after our opponent's last
+// move and our own previous move
+int SearchThread::quiet_history(const Board& board, const SearchStack* ss, Move m) const {
+    Piece pc = board.piece_on(m.from());
+    return history_[board.side_to_move()][m.from()][m.to()]
+         + (*(ss - 1)->cont_hist)[pc][m.to()]
+         + (*(ss - 2)->cont_hist)[pc][m.to()];
+}
+
+void SearchThread::update_quiet_history(const Board& board, const SearchStack* ss, Move m, int bonus) {
+    Piece pc = board.piece_on(m.from());
+    update_history(history_[board.side_to_move()][m.from()][m.to()], bonus);
+    for (int i = 1; i <= 2; ++i) {
+        if ((ss - i)->current_move)
+            update_history((*(ss - i)->cont_hist)[pc][m.to()], bonus);
+    }
+}
+
+// ABDADA bookkeeping only pays off for subtrees of some size
+static constexpr int ABDADA_DEFER_DEPTH = 3;
+
+void SearchThread::score_moves(const Board& board, MoveList& moves, Move tt_move, int ply) {
     // We'll sort moves in-place using a simple selection sort during search
     // For now, we assign scores to guide ordering
     // NOTE: We store scores externally in alpha_beta; this function is a helper
@@ -99,18 +243,24 @@ void Searcher::score_moves(const Board& board, MoveList& moves, Move tt_move, in
 // ============================================================
 // Quiescence search
 // ============================================================
-int Searcher::quiescence(Board& board, SearchInfo& info, int alpha, int beta, int ply) {
+int SearchThread::quiescence(Board& board, SearchInfo& info, int alpha, int beta, SearchStack* ss) {
     info.nodes++;
     info.check_time();
     if (info.stopped) return 0;
 
-    int stand_pat = evaluate(board);
+    // Attack maps are built by the full evaluation, or below once the
+    // stand-pat has not cut off
+    std::optional<AttackInfo> ai;
+    bool lazy;
+    int stand_pat = cached_evaluate(board, ai, alpha, beta, lazy);
+    if (ss->ply >= MAX_PLY) return stand_pat;
 
     if (stand_pat >= beta) return beta;
     if (stand_pat > alpha) alpha = stand_pat;
 
     MoveList captures;
-    generate_captures(board, captures);
+    if (!ai) ai.emplace(board);
+    generate_captures(board, *ai, captures);
 
     // Score captures by MVV-LVA
     int scores[256];
@@ -122,6 +272,10 @@ int Searcher::quiescence(Board& board, SearchInfo& info, int alpha, int beta, in
         scores[i] = MVV_LVA[victim][attacker];
     }
 
+    // Exchange values for pruning, one attacker scan per target square
+    int see_values[256];
+    see_batch(board, captures, see_values);
+
     // Selection sort + search
     for (int i = 0; i < captures.count; ++i) {
         // Find best remaining capture
@@ -132,16 +286,17 @@ int Searcher::quiescence(Board& board, SearchInfo& info, int alpha, int beta, in
         if (best_idx != i) {
             std::swap(captures[i], captures[best_idx]);
             std::swap(scores[i], scores[best_idx]);
+            std::swap(see_values[i], see_values[best_idx]);
         }
 
         Move m = captures[i];
 
         // SEE Pruning in Quiescence
         // Don't search captures that lose material
-        if (!see_ge(board, m, 0)) continue;
+        if (see_values[i] < 0) continue;
 
         board.make_move(m);
-        int score = -quiescence(board, info, -beta, -alpha, ply + 1);
+        int score = -quiescence(board, info, -beta, -alpha, ss + 1);
         board.unmake_move(m);
 
         if (info.stopped) return 0;
@@ -155,49 +310,84 @@ int Searcher::quiescence(Board& board, SearchInfo& info, int alpha, int beta, in
 // ============================================================
 // Alpha-Beta with PVS
 // ============================================================
-int Searcher::alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, int depth, int ply, Move excluded_move) {
-    pv_length_[ply] = ply;
+int SearchThread::alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, int depth, SearchStack* ss) {
+    bool pv_node = beta - alpha > 1;
+    if (pv_node) ss->pv[0] = MOVE_NONE;
 
-    if (depth <= 0) return quiescence(board, info, alpha, beta, ply);
+    if (depth <= 0 || ss->ply >= MAX_PLY) return quiescence(board, info, alpha, beta, ss);
 
     info.nodes++;
     info.check_time();
     if (info.stopped) return 0;
 
+    int ply = ss->ply;
     bool is_root = (ply == 0);
     uint64_t key = board.hash_key();
 
+    // KPK is known exactly: no need to search a bitbase draw
+    if (!is_root && popcount(board.occupied()) == 3 && board.pieces(PAWN)) {
+        Color strong = piece_color(board.piece_on(lsb(board.pieces(PAWN))));
+        if (!kpk_win(board, strong)) return VALUE_DRAW;
+    }
+
+    // Endgame tablebases: exact distance to mate, ignoring the 50-move rule
+    if (!is_root && popcount(board.occupied()) <= tb::max_pieces()
+        && !board.castling_rights() && board.en_passant_sq() == SQ_NONE) {
+        tb::ProbeResult r;
+        if (tb::probe(board, r)) {
+            info.tb_hits++;
+            return r.wdl > 0 ? VALUE_MATE - ply - r.dtm
+                 : r.wdl < 0 ? -VALUE_MATE + ply + r.dtm
+                 : VALUE_DRAW;
+        }
+    }
+
     // TT lookup
     Move tt_move{};
-    TTEntry* tt_entry = probe_tt(key);
-    if (tt_entry && tt_entry->depth >= depth && !is_root) {
-        if (tt_entry->flag == TT_EXACT)
-            return tt_entry->score;
-        if (tt_entry->flag == TT_ALPHA && tt_entry->score <= alpha)
+    TTEntry tte;
+    bool tt_hit = owner_.tt_.probe(key, tte);
+    if (tt_hit && tte.depth >= depth && !is_root) {
+        if (tte.flag == TT_EXACT)
+            return tte.score;
+        if (tte.flag == TT_ALPHA && tte.score <= alpha)
             return alpha;
-        if (tt_entry->flag == TT_BETA && tt_entry->score >= beta)
+        if (tte.flag == TT_BETA && tte.score >= beta)
             return beta;
-        tt_move = tt_entry->best_move;
+        tt_move = tte.best_move;
     }
-    if (tt_entry) tt_move = tt_entry->best_move;
+    if (tt_hit) tt_move = tte.best_move;
 
     // Check extensions
-    bool in_check = board.in_check();
+    std::optional<AttackInfo> attack_info(std::in_place, board);
+    const AttackInfo& ai = *attack_info;
+    bool in_check = ai.checkers != 0;
     if (in_check) depth++;
 
-    // Pruning that requires static evaluation
-    int eval = evaluate(board);
+    // Pruning that requires static evaluation. The window covers the
+    // razoring and RFP thresholds below, so a lazy score decides them
+    // the same way the full one would. It says nothing useful outside
+    // the window, so only a full evaluation is kept on the stack.
+    bool lazy;
+    int eval = cached_evaluate(board, attack_info, alpha - 300 * 2, beta + 120 * 4, lazy);
+    ss->static_eval = in_check || lazy ? VALUE_NONE : eval;
+
+    // Improving: our eval is above what it was on our previous move (or
+    // the one before, if that one is unknown). Without a full eval on
+    // both sides there is nothing to compare, and we assume improving,
+    // which prunes and reduces least.
+    int prev_eval = (ss - 2)->static_eval != VALUE_NONE ? (ss - 2)->static_eval : (ss - 4)->static_eval;
+    bool improving = !in_check && (lazy || prev_eval == VALUE_NONE || eval > prev_eval);
 
     if (!is_root && !in_check) {
         // Razoring: if eval is way below alpha, it's likely a quiet node that won't improve alpha
         if (depth <= 2 && eval <= alpha - 300 * depth) {
-            int score = quiescence(board, info, alpha, beta, ply);
+            int score = quiescence(board, info, alpha, beta, ss);
             if (score <= alpha) return score;
         }
 
         // Reverse Futility Pruning (RFP) / Static Null Move Pruning
         // If static eval is way above beta, assume it will fail high
-        int margin = 120 * depth;
+        int margin = 120 * (depth - improving);
         if (depth <= 4 && eval - margin >= beta) {
             return eval;
         }
@@ -212,15 +402,17 @@ int Searcher::alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, in
     // Null Move Pruning (NMP)
     // If we can fail high even if we give the opponent a free move, we can likely prune this node
     if (depth >= 3 && !in_check && !is_root && board.has_nonPawn_material(board.side_to_move())) {
+        ss->current_move = MOVE_NONE;
+        ss->cont_hist = &cont_hist_[NO_PIECE][0];
         board.make_null_move();
         // R = 2 is standard for simple engines
-        int score = -alpha_beta(board, info, -beta, -beta + 1, depth - 1 - 2, ply + 1);
+        int score = -alpha_beta(board, info, -beta, -beta + 1, depth - 1 - 2, ss + 1);
         board.unmake_null_move();
 
         if (score >= beta) {
             // Verification search at high depths to avoid zugzwang risks
             if (depth >= 7) {
-                int v_score = alpha_beta(board, info, alpha, beta, depth - 4, ply);
+                int v_score = alpha_beta(board, info, alpha, beta, depth - 4, ss);
                 if (v_score >= beta) return beta;
             } else {
                 return beta;
@@ -230,28 +422,37 @@ int Searcher::alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, in
 
     // Singular Extensions
     int extension = 0;
-    if (depth >= 8 && tt_entry && tt_entry->depth >= depth - 3 && tt_entry->flag != TT_ALPHA && !excluded_move && !is_root) {
+    if (depth >= 8 && tt_hit && tte.depth >= depth - 3 && tte.flag != TT_ALPHA && !ss->excluded_move && !is_root) {
         int margin = 2 * depth;
-        int tt_score = tt_entry->score;
-        int s_score = alpha_beta(board, info, tt_score - margin - 1, tt_score - margin, (depth - 1) / 2, ply, tt_move);
-        
+        int tt_score = tte.score;
+        ss->excluded_move = tt_move;
+        int s_score = alpha_beta(board, info, tt_score - margin - 1, tt_score - margin, (depth - 1) / 2, ss);
+        ss->excluded_move = MOVE_NONE;
+
         if (s_score < tt_score - margin)
             extension = 1;
     }
 
     // Generate legal moves
     MoveList moves;
-    generate_moves(board, moves);
+    generate_moves(board, ai, moves);
 
     // Checkmate / Stalemate
     if (moves.count == 0) {
-        if (board.in_check())
+        if (in_check)
             return -VALUE_MATE + ply;  // checkmate
         return VALUE_DRAW;  // stalemate
     }
 
-    // Score moves for ordering
+    // Quiet reply that last refuted the opponent's move
+    Move prev_move = (ss - 1)->current_move;
+    Move counter_move = prev_move ? counter_moves_[board.piece_on(prev_move.to())][prev_move.to()]
+                                  : MOVE_NONE;
+
+    // Score moves for ordering. Exchange values are shared with SEE pruning.
     int move_scores[256];
+    int see_values[256];
+    see_batch(board, moves, see_values);
     for (int i = 0; i < moves.count; ++i) {
         Move m = moves[i];
         if (m == tt_move) {
@@ -263,14 +464,15 @@ int Searcher::alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, in
                 PieceType attacker = piece_type(board.piece_on(m.from()));
                 move_scores[i] = 50000 + MVV_LVA[victim][attacker];
                 // Boost captures that are safe/winning
-                if (see_ge(board, m, 0)) move_scores[i] += 10000;
-            } else if (m == killers_[ply][0]) {
+                if (see_values[i] >= 0) move_scores[i] += 10000;
+            } else if (m == ss->killers[0]) {
                 move_scores[i] = 40000;
-            } else if (m == killers_[ply][1]) {
+            } else if (m == ss->killers[1]) {
                 move_scores[i] = 39000;
+            } else if (m == counter_move) {
+                move_scores[i] = 38000;
             } else {
-                Color us = board.side_to_move();
-                move_scores[i] = history_[us][m.from()][m.to()];
+                move_scores[i] = quiet_history(board, ss, m) + threat_score(board, ai, m);
             }
         }
     }
@@ -280,65 +482,119 @@ int Searcher::alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, in
     TTFlag tt_flag = TT_ALPHA;
     int legal_count = 0;
 
-    for (int i = 0; i < moves.count; ++i) {
-        // Selection sort: pick best-scoring move
-        int best_idx = i;
-        for (int j = i + 1; j < moves.count; ++j) {
-            if (move_scores[j] > move_scores[best_idx]) best_idx = j;
-        }
-        if (best_idx != i) {
-            std::swap(moves[i], moves[best_idx]);
-            std::swap(move_scores[i], move_scores[best_idx]);
+    // ABDADA: moves another thread is already searching are put off
+    // until the rest of the list is done
+    bool abdada = depth >= ABDADA_DEFER_DEPTH && owner_.abdada_active();
+    Move deferred[256];
+    int deferred_count = 0;
+
+    // Quiet moves searched without a cutoff, penalised if a later one cuts
+    Move quiets_tried[64];
+    int quiet_count = 0;
+
+    // Children's PV, only kept below PV nodes
+    Move pv[MAX_PLY + 1];
+    (ss + 1)->pv = pv_node ? pv : nullptr;
+
+    for (int i = 0; i < moves.count + deferred_count; ++i) {
+        bool deferred_pass = i >= moves.count;
+        Move m;
+        if (deferred_pass) {
+            m = deferred[i - moves.count];
+        } else {
+            // Selection sort: pick best-scoring move
+            int best_idx = i;
+            for (int j = i + 1; j < moves.count; ++j) {
+                if (move_scores[j] > move_scores[best_idx]) best_idx = j;
+            }
+            if (best_idx != i) {
+                std::swap(moves[i], moves[best_idx]);
+                std::swap(move_scores[i], move_scores[best_idx]);
+                std::swap(see_values[i], see_values[best_idx]);
+            }
+            m = moves[i];
         }
-
-        Move m = moves[i];
-        if (m == excluded_move) continue;
+        if (m == ss->excluded_move) continue;
 
         Piece captured = board.piece_on(m.to());
 
         // SEE Pruning in Search
         // Prune captures that lose material at shallow depths
-        if (depth <= 4 && captured != NO_PIECE && !see_ge(board, m, 0)) {
+        if (!deferred_pass && depth <= 4 && captured != NO_PIECE && see_values[i] < 0) {
             continue;
         }
 
+        bool quiet = captured == NO_PIECE && !m.is_promotion() && !m.is_en_passant();
+        int threat = quiet ? threat_score(board, ai, m) : 0;
+        int history = quiet ? quiet_history(board, ss, m) : 0;
+
         // Late Move Pruning (LMP)
-        // Skip quiet moves deep in the move list at shallow depths
-        int lmp_threshold = 3 + 2 * depth * depth;
-        if (depth <= 4 && !in_check && legal_count > lmp_threshold && captured == NO_PIECE && !m.is_promotion() && !m.is_en_passant()) {
+        // Skip quiet moves deep in the move list at shallow depths, never
+        // one that saves a threatened piece
+        int lmp_threshold = improving ? 3 + 2 * depth * depth : 2 + depth * depth;
+        if (!deferred_pass && depth <= 4 && !in_check && legal_count > lmp_threshold && quiet && threat <= 0) {
             continue;
         }
 
+        // The first move is always searched; later ones wait if busy
+        uint64_t move_key = 0;
+        if (abdada) {
+            move_key = key ^ ((uint64_t(m.data) + 1) * 0x9E3779B97F4A7C15ULL);
+            if (!deferred_pass && legal_count > 0 && owner_.abdada_busy(move_key)) {
+                deferred[deferred_count++] = m;
+                continue;
+            }
+            owner_.abdada_enter(move_key);
+        }
+
+        // Overlap the child's TT miss with make_move; shallow children go
+        // straight to quiescence, which does not probe
+        if (depth > 1) owner_.tt_.prefetch(board.key_after(m));
+
+        ss->current_move = m;
+        ss->cont_hist = &cont_hist_[board.piece_on(m.from())][m.to()];
+        if (pv_node) pv[0] = MOVE_NONE;
         board.make_move(m);
         legal_count++;
 
         int score;
         if (legal_count == 1) {
             // Full window search for the first move (PV move)
-            score = -alpha_beta(board, info, -beta, -alpha, depth - 1 + extension, ply + 1);
+            score = -alpha_beta(board, info, -beta, -alpha, depth - 1 + extension, ss + 1);
         } else {
             // Late Move Reductions (LMR)
             int r = 0;
             if (depth >= 3 && legal_count > 4 && captured == NO_PIECE && !in_check && !m.is_promotion()) {
-                r = reductions_[std::min(63, depth)][std::min(63, legal_count)];
+                r = Reductions[std::min(63, depth)][std::min(63, legal_count)];
                 // Reduce less if not alpha-beta window (already handled by null window)
+
+                // Escapes from a threat are searched deeper, moves into one shallower
+                if (threat > 0) r = std::max(0, r - 1);
+                else if (threat < 0) r++;
+
+                if (!improving) r++;
+
+                // Well-tried quiets are reduced less, poor ones more
+                r -= history / (HISTORY_MAX * 3 / 4);
+                r = std::max(0, r);
             }
 
             // Search with null window and possible reduction
-            score = -alpha_beta(board, info, -alpha - 1, -alpha, depth - 1 - r, ply + 1);
+            score = -alpha_beta(board, info, -alpha - 1, -alpha, depth - 1 - r, ss + 1);
 
             // Re-search if reduced search failed high
             if (score > alpha && r > 0) {
-                score = -alpha_beta(board, info, -alpha - 1, -alpha, depth - 1, ply + 1);
+                score = -alpha_beta(board, info, -alpha - 1, -alpha, depth - 1, ss + 1);
             }
 
             // PVS re-search: if null window search failed high, re-search with full window
             if (score > alpha && score < beta) {
-                score = -alpha_beta(board, info, -beta, -alpha, depth - 1, ply + 1);
+                score = -alpha_beta(board, info, -beta, -alpha, depth - 1, ss + 1);
             }
         }
 
         board.unmake_move(m);
+        if (abdada) owner_.abdada_leave(move_key);
 
         if (info.stopped) return 0;
 
@@ -350,69 +606,77 @@ int Searcher::alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, in
                 alpha = score;
                 tt_flag = TT_EXACT;
 
-                // Update PV
-                pv_table_[ply][ply] = m;
-                for (int j = ply + 1; j < pv_length_[ply + 1]; ++j) {
-                    pv_table_[ply][j] = pv_table_[ply + 1][j];
-                }
-                pv_length_[ply] = pv_length_[ply + 1];
-
-                // History heuristic update (quiet moves only)
-                if (captured == NO_PIECE && !m.is_en_passant()) {
-                    Color us = board.side_to_move();
-                    // Simple additive update with saturation
-                    int bonus = depth * depth;
-                    if (history_[us][m.from()][m.to()] < 1000000)
-                        history_[us][m.from()][m.to()] += bonus;
-                }
+                if (pv_node) update_pv(ss->pv, m, pv);
             }
 
             if (score >= beta) {
                 // Beta cutoff
-                store_tt(key, depth, beta, TT_BETA, m);
-
-                // Killer/History update (quiet moves only)
-                if (captured == NO_PIECE && !m.is_en_passant()) {
-                    killers_[ply][1] = killers_[ply][0];
-                    killers_[ply][0] = m;
-
-                    Color us = board.side_to_move();
-                    int bonus = depth * depth;
-                    if (history_[us][m.from()][m.to()] < 1000000)
-                        history_[us][m.from()][m.to()] += bonus;
+                owner_.tt_.store(key, depth, beta, TT_BETA, m);
+
+                // Quiet cutoff: reward the move, penalise the quiets
+                // searched before it
+                if (quiet) {
+                    if (ss->killers[0] != m) {
+                        ss->killers[1] = ss->killers[0];
+                        ss->killers[0] = m;
+                    }
+                    if (prev_move)
+                        counter_moves_[board.piece_on(prev_move.to())][prev_move.to()] = m;
+
+                    int bonus = history_bonus(depth);
+                    update_quiet_history(board, ss, m, bonus);
+                    for (int j = 0; j < quiet_count; ++j)
+                        update_quiet_history(board, ss, quiets_tried[j], -bonus);
                 }
 
                 return beta;
             }
         }
+
+        if (quiet && quiet_count < 64) quiets_tried[quiet_count++] = m;
     }
 
-    store_tt(key, depth, best_score, tt_flag, best_move);
+    owner_.tt_.store(key, depth, best_score, tt_flag, best_move);
     return best_score;
 }
 
 // ============================================================
 // Iterative deepening
 // ============================================================
-Move Searcher::search(Board& board, SearchInfo& info) {
-    info.start_time = std::chrono::steady_clock::now();
+
+// Lazy SMP helper threads skip some depths so they spread over more
+// than one iteration at a time (thread i uses entry (i - 1) % 20).
+// ABDADA threads all search the same iteration and split it by move.
+static constexpr int SkipSize[20]  = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4};
+static constexpr int SkipPhase[20] = {0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7};
+
+void SearchThread::search(const Board& root, SearchInfo& info) {
+    board_ = root;
     info.nodes = 0;
+    info.tb_hits = 0;
     info.stopped = false;
 
-    // Clear PV
-    std::memset(pv_length_, 0, sizeof(pv_length_));
+    // The root's PV is the iteration's result
+    stack_[STACK_OFFSET].pv = root_pv_;
+    root_pv_[0] = MOVE_NONE;
+    best_pv_length_ = 0;
+    completed_depth_ = 0;
+
+    // Keep NNUE accumulators in sync with the search line
+    if (nnue::enabled()) board_.attach_accumulators(&nnue_stack_);
 
-    Move best_move{};
     int max_depth = info.max_depth;
     if (max_depth <= 0) max_depth = 64;
 
     best_move_changes_ = 0;
     last_best_move_ = MOVE_NONE;
 
-    // Increment TT age for the new search
-    tt_age_++;
-
     for (int depth = 1; depth <= max_depth; ++depth) {
+        if (id_ > 0 && !owner_.abdada_active()) {
+            int i = (id_ - 1) % 20;
+            if (((depth + SkipPhase[i]) / SkipSize[i]) % 2) continue;
+        }
+
         int score;
         int alpha = -VALUE_INFINITE;
         int beta = VALUE_INFINITE;
@@ -425,7 +689,7 @@ Move Searcher::search(Board& board, SearchInfo& info) {
         }
 
         while (true) {
-            score = alpha_beta(board, info, alpha, beta, depth, 0);
+            score = alpha_beta(board_, info, alpha, beta, depth, &stack_[STACK_OFFSET]);
 
             if (info.stopped) break;
 
@@ -453,40 +717,39 @@ Move Searcher::search(Board& board, SearchInfo& info) {
         if (info.stopped) break;
 
         info.last_score = score;
-        Move current_best = pv_table_[0][0];
+        Move current_best = root_pv_[0];
 
         if (depth > 1 && current_best != last_best_move_) {
             best_move_changes_++;
         }
         last_best_move_ = current_best;
-        best_move = current_best;
-
-        // Print UCI info
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - info.start_time).count();
-        int64_t nps = (elapsed > 0) ? (static_cast<int64_t>(info.nodes) * 1000 / elapsed) : 0;
-
-        std::cout << "info depth " << depth
-                  << " score cp " << score
-                  << " nodes " << info.nodes
-                  << " nps " << nps
-                  << " time " << elapsed
-                  << " pv";
-
-        for (int i = 0; i < pv_length_[0]; ++i) {
-            std::cout << " " << pv_table_[0][i].to_uci();
+
+        best_score_ = score;
+        completed_depth_ = depth;
+        best_pv_length_ = 0;
+        while (root_pv_[best_pv_length_] != MOVE_NONE) {
+            best_pv_[best_pv_length_] = root_pv_[best_pv_length_];
+            best_pv_length_++;
         }
-        std::cout << std::endl;
-
-        // Adaptive time management
-        if (info.time_limit_ms > 0 && !info.infinite) {
-            // Soft limit: stop if we've used a significant portion of our time
-            // and the best move has been stable for long enough.
-            double stability_factor = (best_move_changes_ > 0) ? 1.5 : 0.8;
-            int64_t optimum_time = info.time_limit_ms / 3;
-            
-            if (elapsed > optimum_time * stability_factor && depth >= 6) {
-                break;
+        stats.nodes.store(info.nodes, std::memory_order_relaxed);
+        stats.tb_hits.store(info.tb_hits, std::memory_order_relaxed);
+
+        if (id_ == 0) {
+            // Print UCI info
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - info.start_time).count();
+            print_info(elapsed);
+
+            // Adaptive time management
+            if (info.time_limit_ms > 0 && !info.infinite) {
+                // Soft limit: stop if we've used a significant portion of our time
+                // and the best move has been stable for long enough.
+                double stability_factor = (best_move_changes_ > 0) ? 1.5 : 0.8;
+                int64_t optimum_time = info.time_limit_ms / 3;
+
+                if (elapsed > optimum_time * stability_factor && depth >= 6) {
+                    break;
+                }
             }
         }
 
@@ -495,7 +758,120 @@ Move Searcher::search(Board& board, SearchInfo& info) {
             break;
     }
 
-    return best_move;
+    stats.nodes.store(info.nodes, std::memory_order_relaxed);
+    stats.tb_hits.store(info.tb_hits, std::memory_order_relaxed);
+    board_.attach_accumulators(nullptr);
+}
+
+void SearchThread::print_info(int64_t elapsed) const {
+    uint64_t nodes = owner_.nodes_searched();
+    int64_t nps = (elapsed > 0) ? (static_cast<int64_t>(nodes) * 1000 / elapsed) : 0;
+
+    std::cout << "info depth " << completed_depth_
+              << " score cp " << best_score_
+              << " nodes " << nodes
+              << " nps " << nps
+              << " tbhits " << owner_.tb_hits()
+              << " hashfull " << owner_.hashfull()
+              << " time " << elapsed
+              << " pv";
+
+    for (int i = 0; i < best_pv_length_; ++i) {
+        std::cout << " " << best_pv_[i].to_uci();
+    }
+    std::cout << std::endl;
+}
+
+Move Searcher::search(Board& board, SearchInfo& info) {
+    stop_ = false;
+    return run(board, info);
+}
+
+void Searcher::start(const Board& board, const SearchInfo& info, std::function<void(Move)> done) {
+    stop();
+    stop_ = false;
+    root_board_ = board;
+    root_info_ = info;
+    main_thread_ = std::thread([this, done = std::move(done)] {
+        done(run(root_board_, root_info_));
+    });
+}
+
+void Searcher::stop() {
+    stop_ = true;
+    wait();
+}
+
+void Searcher::wait() {
+    if (main_thread_.joinable()) main_thread_.join();
+}
+
+Move Searcher::run(Board& board, SearchInfo& info) {
+    info.start_time = std::chrono::steady_clock::now();
+
+    // Increment TT age for the new search
+    tt_.new_search();
+
+    for (auto& t : threads_) {
+        t->stats.nodes = 0;
+        t->stats.tb_hits = 0;
+    }
+
+    // Helpers search the same root without time control until thread 0
+    // finishes, sharing results through the TT
+    std::vector<SearchInfo> helper_info(threads_.size(), info);
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threads_.size(); ++i) {
+        helper_info[i].time_limit_ms = 0;
+        helper_info[i].stop = &stop_;
+        helper_info[i].stats = &threads_[i]->stats;
+        helpers.emplace_back([this, &board, &helper_info, i] {
+            threads_[i]->search(board, helper_info[i]);
+        });
+    }
+
+    info.stop = &stop_;
+    info.stats = &threads_[0]->stats;
+    threads_[0]->search(board, info);
+
+    // An infinite search that ran out of depth (or found a mate) holds
+    // its bestmove until the GUI sends stop
+    while (info.infinite && !stop_.load(std::memory_order_relaxed))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    stop_ = true;
+    for (auto& h : helpers) h.join();
+    info.nodes = nodes_searched();
+    info.tb_hits = tb_hits();
+
+    // Vote for the best move: each thread backs its move with its depth
+    // and how much its score beats the worst thread's
+    SearchThread* best = threads_[0].get();
+    if (threads_.size() > 1) {
+        int min_score = VALUE_INFINITE;
+        for (auto& t : threads_)
+            if (t->best_move()) min_score = std::min(min_score, t->best_score());
+
+        std::unordered_map<uint16_t, int64_t> votes;
+        for (auto& t : threads_)
+            if (t->best_move())
+                votes[t->best_move().data] += int64_t(t->best_score() - min_score + 14) * t->completed_depth();
+
+        for (auto& t : threads_) {
+            if (!t->best_move()) continue;
+            if (!best->best_move()
+                || votes[t->best_move().data] > votes[best->best_move().data]
+                || (t->best_move() == best->best_move() && t->completed_depth() > best->completed_depth()))
+                best = t.get();
+        }
+
+        if (best != threads_[0].get()) {
+            best->print_info(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - info.start_time).count());
+        }
+    }
+
+    return best->best_move();
 }
 
 } // namespace chess
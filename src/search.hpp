@@ -1,36 +1,41 @@
 #pragma once
 
+#include "attackinfo.hpp"
 #include "board.hpp"
+#include "tt.hpp"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
 
 namespace chess {
 
 // ============================================================
-// Transposition table entry
+// Static evaluation cache entry (direct-mapped, 8 bytes)
 // ============================================================
-enum TTFlag : uint8_t {
-    TT_EXACT,
-    TT_ALPHA,  // upper bound (failed low)
-    TT_BETA    // lower bound (failed high)
-};
-
-struct TTEntry {
-    uint64_t key = 0;
-    int      depth = 0;
-    int      score = 0;
-    TTFlag   flag = TT_EXACT;
-    Move     best_move{};
-    uint8_t  age = 0;
+struct EvalCacheEntry {
+    uint32_t key = 0;   // Upper 32 bits of the Zobrist key
+    int32_t  score = 0;
 };
 
 // ============================================================
 // Search information
 // ============================================================
+
+// Counters a thread publishes for aggregated reporting
+struct ThreadStats {
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<uint64_t> tb_hits{0};
+};
+
 struct SearchInfo {
     int      depth = 0;
     int      max_depth = 64;
-    int      nodes = 0;
+    uint64_t nodes = 0;
+    uint64_t tb_hits = 0;
     bool     stopped = false;
 
     // Aspiration windows
@@ -41,7 +46,19 @@ struct SearchInfo {
     int64_t  time_limit_ms = 0;  // 0 = no limit
     bool     infinite = false;
 
+    // Shared by the threads of one search
+    std::atomic<bool>* stop = nullptr;
+    ThreadStats*       stats = nullptr;
+
     void check_time() {
+        if ((nodes & 1023) == 0) {
+            if (stats) {
+                stats->nodes.store(nodes, std::memory_order_relaxed);
+                stats->tb_hits.store(tb_hits, std::memory_order_relaxed);
+            }
+            if (stop && stop->load(std::memory_order_relaxed))
+                stopped = true;
+        }
         if (time_limit_ms > 0 && (nodes & 2047) == 0) {
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::steady_clock::now() - start_time).count();
@@ -52,52 +69,187 @@ struct SearchInfo {
 };
 
 // ============================================================
-// Searcher
+// History bounded by gravity updates (see update_history)
 // ============================================================
-class Searcher {
+constexpr int HISTORY_MAX = 8192;
+
+// History of a quiet move after one particular earlier move,
+// indexed by [piece][to] of the later move
+using PieceToHistory = int16_t[PIECE_NB][SQUARE_NB];
+
+// ============================================================
+// Per-ply search state. Each thread keeps one array of these; a node
+// at ply p works on entry p and reaches its ancestors and children
+// through neighbouring entries.
+// ============================================================
+struct alignas(32) SearchStack {
+    Move* pv;              // PV of this node; null below non-PV nodes
+    PieceToHistory* cont_hist;  // Continuation history of current_move
+    int   ply;
+    int   static_eval;     // VALUE_NONE when in check
+    Move  current_move;    // Move being searched from this node
+    Move  excluded_move;   // Skipped by the singular extension search
+    Move  killers[2];
+};
+
+static_assert(sizeof(SearchStack) == 32, "two search stack entries per cache line");
+
+class Searcher;
+
+// ============================================================
+// Search thread: its own board copy, heuristics and caches; the
+// transposition table is shared through the owning Searcher
+// ============================================================
+class SearchThread {
 public:
-    Searcher();
+    SearchThread(Searcher& owner, int id);
 
-    // Run iterative deepening search and return the best move
-    Move search(Board& board, SearchInfo& info);
+    // Iterative deepening on a copy of the root position. Thread 0
+    // prints UCI info and manages time; helpers only fill the TT.
+    void search(const Board& root, SearchInfo& info);
 
-    // Clear transposition table and heuristics
     void clear();
+    void set_eval_cache_size(int mb);
+
+    // Result of the last completed iteration
+    Move best_move() const { return best_pv_length_ ? best_pv_[0] : MOVE_NONE; }
+    int  best_score() const { return best_score_; }
+    int  completed_depth() const { return completed_depth_; }
+
+    // "info depth ... pv ..." for the last completed iteration
+    void print_info(int64_t elapsed_ms) const;
+
+    ThreadStats stats;
 
 private:
-    // Transposition table
-    static constexpr int TT_SIZE = 1 << 20; // ~1M entries
-    std::vector<TTEntry> tt_;
+    Searcher& owner_;
+    int       id_;
+    Board     board_;
 
-    // Killer moves (2 per ply)
-    Move killers_[256][2];
+    // Static evaluation cache
+    std::vector<EvalCacheEntry> eval_cache_;
+    int cached_evaluate(const Board& board, std::optional<AttackInfo>& ai, int alpha, int beta, bool& lazy);
+
+    // NNUE accumulators for the board being searched
+    nnue::AccumulatorStack nnue_stack_;
+
+    // Search stack; STACK_OFFSET sentinel entries below the root let a
+    // node look a few plies back without bounds checks
+    static constexpr int STACK_OFFSET = 4;
+    alignas(64) SearchStack stack_[MAX_PLY + STACK_OFFSET + 1];
+    Move root_pv_[MAX_PLY + 1];
 
     // History heuristic [color][from][to]
     int history_[2][64][64];
 
-    // PV tracking
-    Move pv_table_[256][256];
-    int  pv_length_[256];
+    // Continuation history [piece][to] of a move one or two plies back,
+    // and the quiet move that last refuted a move [piece][to]. Entry
+    // [NO_PIECE][0] stays zero and stands in for the null move.
+    PieceToHistory cont_hist_[PIECE_NB][SQUARE_NB];
+    Move counter_moves_[PIECE_NB][SQUARE_NB];
 
     // Core search functions
-    int alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, int depth, int ply, Move excluded_move = MOVE_NONE);
-    int quiescence(Board& board, SearchInfo& info, int alpha, int beta, int ply);
+    int alpha_beta(Board& board, SearchInfo& info, int alpha, int beta, int depth, SearchStack* ss);
+    int quiescence(Board& board, SearchInfo& info, int alpha, int beta, SearchStack* ss);
 
     // Move ordering
     void score_moves(const Board& board, MoveList& moves, Move tt_move, int ply);
+    int  quiet_history(const Board& board, const SearchStack* ss, Move m) const;
+    void update_quiet_history(const Board& board, const SearchStack* ss, Move m, int bonus);
 
-    // TT probing
-    TTEntry* probe_tt(uint64_t key);
-    void store_tt(uint64_t key, int depth, int score, TTFlag flag, Move best);
+    // Last completed iteration
+    Move    best_pv_[MAX_PLY + 1];
+    int     best_pv_length_ = 0;
+    int     best_score_ = 0;
+    int     completed_depth_ = 0;
 
-    // LMR
-    int reductions_[64][64];
-    void init_reductions();
-
-    // TT aging / Stability
-    uint8_t tt_age_ = 0;
+    // Stability
     Move    last_best_move_{};
     int     best_move_changes_ = 0;
 };
 
+// ============================================================
+// Searcher: Lazy SMP over a shared transposition table
+// ============================================================
+class Searcher {
+public:
+    Searcher();
+    ~Searcher() { stop(); }
+
+    // Run iterative deepening search and return the best move
+    Move search(Board& board, SearchInfo& info);
+
+    // Search a copy of the position on a background thread and pass the
+    // best move to 'done' from that thread. An infinite search reports
+    // only once stopped. stop() ends a running search and waits for it;
+    // wait() lets it finish on its own.
+    void start(const Board& board, const SearchInfo& info, std::function<void(Move)> done);
+    void stop();
+    void wait();
+
+    // Clear transposition table and heuristics
+    void clear();
+
+    // Called on ucinewgame: a full clear, or with set_newgame_clear(false)
+    // only a generation bump, so the previous game's entries stay
+    // probeable but are replaced first
+    void new_game();
+    void set_newgame_clear(bool on) { newgame_clear_ = on; }
+
+    // Resize each thread's static evaluation cache (in MB)
+    void set_eval_cache_size(int mb);
+
+    // Number of search threads (thread 0 runs on the caller). They also
+    // share the work of clearing and allocating the hash table.
+    void set_threads(int n);
+    int thread_count() const { return int(threads_.size()); }
+
+    // Transposition table size in MB, and how full it is (permille)
+    void set_hash_size(int mb) { tt_.resize(size_t(std::max(mb, 1)), thread_count()); }
+    int  hashfull() const { return tt_.hashfull(); }
+    size_t hash_size_mb() const { return tt_.size_mb(); }
+    const char* hash_page_mode() const { return tt_.page_mode(); }
+
+    // Share the transposition table with other processes (empty: private)
+    bool set_shared_hash(const std::string& name) { return tt_.set_shared(name, thread_count()); }
+
+    // Persist the transposition table between sessions
+    bool save_hash(const std::string& path) const { return tt_.save(path); }
+    bool load_hash(const std::string& path) { return tt_.load(path, thread_count()); }
+
+    // Nodes and tablebase hits of the current search, all threads
+    uint64_t nodes_searched() const;
+    uint64_t tb_hits() const;
+
+    // Split each iteration by move (ABDADA) instead of Lazy SMP
+    void set_abdada(bool on) { abdada_on_ = on; }
+    bool abdada_active() const { return abdada_on_ && threads_.size() > 1; }
+
+private:
+    friend class SearchThread;
+
+    // Transposition table, shared by all threads
+    TranspositionTable tt_;
+
+    // ABDADA table of moves in progress
+    static constexpr int ABDADA_BUCKETS = 32768;
+    static constexpr int ABDADA_WAYS = 4;
+    std::unique_ptr<std::atomic<uint64_t>[]> abdada_;
+    bool abdada_on_ = false;
+    bool abdada_busy(uint64_t move_key) const;
+    void abdada_enter(uint64_t move_key);
+    void abdada_leave(uint64_t move_key);
+
+    std::vector<std::unique_ptr<SearchThread>> threads_;
+    int eval_cache_mb_ = 4;
+    bool newgame_clear_ = true;
+    std::atomic<bool> stop_{false};
+
+    // Background search started by start()
+    std::thread main_thread_;
+    Board root_board_;
+    SearchInfo root_info_;
+    Move run(Board& board, SearchInfo& info);
+};
+
 } // namespace chess
@@ -63,4 +63,97 @@ bool see_ge(const Board& board, Move m, int threshold) {
     return bool(res);
 }
 
+// ============================================================
+// Exchange value (swap list)
+// ============================================================
+
+// Value of the exchange on 'to' once the first capture has been made.
+// 'occupied' and 'attackers' already exclude the first attacker.
+static int exchange(const Board& board, Square to, PieceType first, int captured,
+                    Bitboard occupied, Bitboard attackers) {
+    int gain[40];
+    int d = 0;
+    gain[0] = captured;
+
+    PieceType last = first;
+    Color stm = ~board.side_to_move();
+    while (true) {
+        // Gain if 'stm' can take the last capturer
+        ++d;
+        gain[d] = PieceValue[last] - gain[d - 1];
+
+        attackers &= occupied;
+        Bitboard stm_attackers = attackers & board.pieces(stm);
+        if (!stm_attackers) break;
+
+        PieceType pt = PAWN;
+        while (!(stm_attackers & board.pieces(pt))) pt = PieceType(pt + 1);
+
+        occupied ^= square_bb(lsb(stm_attackers & board.pieces(pt)));
+        if (pt == PAWN || pt == BISHOP || pt == QUEEN)
+            attackers |= get_bishop_attacks(to, occupied) & (board.pieces(BISHOP) | board.pieces(QUEEN));
+        if (pt == ROOK || pt == QUEEN)
+            attackers |= get_rook_attacks(to, occupied) & (board.pieces(ROOK) | board.pieces(QUEEN));
+
+        last = pt;
+        stm = ~stm;
+    }
+
+    // The last gain is speculative: nobody was left to make that capture
+    while (--d)
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    return gain[0];
+}
+
+static int captured_value(const Board& board, Move m) {
+    if (m.is_en_passant()) return PieceValue[PAWN];
+    return PieceValue[piece_type(board.piece_on(m.to()))];
+}
+
+int see(const Board& board, Move m) {
+    if (m.type() == MT_CASTLING) return 0;
+
+    Square from = m.from();
+    Square to = m.to();
+    Bitboard occupied = board.occupied() ^ square_bb(from) ^ square_bb(to);
+    return exchange(board, to, piece_type(board.piece_on(from)), captured_value(board, m),
+                    occupied, board.attackers_to(to, occupied));
+}
+
+void see_batch(const Board& board, const MoveList& moves, int* values) {
+    Bitboard scanned = EMPTY_BB;
+    Bitboard attackers_on[SQUARE_NB];
+    Bitboard bishops = board.pieces(BISHOP) | board.pieces(QUEEN);
+    Bitboard rooks = board.pieces(ROOK) | board.pieces(QUEEN);
+
+    for (int i = 0; i < moves.count; ++i) {
+        Move m = moves[i];
+        Square to = m.to();
+        if (m.type() == MT_CASTLING || (board.piece_on(to) == NO_PIECE && !m.is_en_passant())) {
+            values[i] = 0;
+            continue;
+        }
+
+        // Attackers with every piece in place, shared by all captures on 'to'
+        if (!(scanned & square_bb(to))) {
+            attackers_on[to] = board.attackers_to(to, board.occupied());
+            scanned |= square_bb(to);
+        }
+
+        // Lifting the capturing piece can only uncover sliders on its line
+        Square from = m.from();
+        Bitboard occupied = board.occupied() ^ square_bb(from) ^ square_bb(to);
+        Bitboard attackers = attackers_on[to];
+        if (LineBB[from][to]) {
+            if (file_of(from) == file_of(to) || rank_of(from) == rank_of(to))
+                attackers |= get_rook_attacks(to, occupied) & rooks;
+            else
+                attackers |= get_bishop_attacks(to, occupied) & bishops;
+        }
+
+        values[i] = exchange(board, to, piece_type(board.piece_on(from)), captured_value(board, m),
+                             occupied, attackers);
+    }
+}
+
 } // namespace chess
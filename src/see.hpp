@@ -8,4 +8,12 @@ namespace chess {
 // greater or equal to the given threshold.
 bool see_ge(const Board& board, Move m, int threshold = 0);
 
+// Exchange value of a move for the side to move, in centipawns
+int see(const Board& board, Move m);
+
+// SEE of every capture in 'moves' (0 for the other moves), written to
+// values[i]. Attackers are computed once per target square, so several
+// captures on the same square cost a single scan.
+void see_batch(const Board& board, const MoveList& moves, int* values);
+
 } // namespace chess
@@ -0,0 +1,324 @@
+#include "tbprobe.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace chess {
+namespace tb {
+
+// ============================================================
+// Naming
+// ============================================================
+static constexpr char PieceLetter[PIECE_TYPE_NB] = {' ', 'P', 'N', 'B', 'R', 'Q', 'K'};
+
+static PieceType letter_type(char c) {
+    for (int pt = PAWN; pt <= KING; ++pt)
+        if (PieceLetter[pt] == c) return PieceType(pt);
+    return NO_PIECE_TYPE;
+}
+
+// "K" followed by the side's other pieces, strongest first
+static std::string side_string(const Board& board, Color c, int& value) {
+    std::string s = "K";
+    value = 0;
+    for (int pt = QUEEN; pt >= PAWN; --pt) {
+        int n = popcount(board.pieces(c, PieceType(pt)));
+        s.append(n, PieceLetter[pt]);
+        value += n * PieceValue[pt];
+    }
+    return s;
+}
+
+std::string table_name(const Board& board, bool& flipped) {
+    int vw, vb;
+    std::string w = side_string(board, WHITE, vw);
+    std::string b = side_string(board, BLACK, vb);
+    flipped = vb > vw || (vb == vw && b > w);
+    return flipped ? b + "v" + w : w + "v" + b;
+}
+
+bool parse_table_name(const std::string& name, Table& table) {
+    size_t v = name.find('v');
+    if (v == std::string::npos || name[0] != 'K' || v + 1 >= name.size() || name[v + 1] != 'K')
+        return false;
+
+    std::string sides[COLOR_NB] = {name.substr(1, v - 1), name.substr(v + 2)};
+    table.name = name;
+    table.count = 2;
+    table.pawns = false;
+    table.pieces[0] = W_KING;
+    table.pieces[1] = B_KING;
+
+    for (int c = 0; c < 2; ++c) {
+        for (char ch : sides[c]) {
+            PieceType pt = letter_type(ch);
+            if (pt == NO_PIECE_TYPE || pt == KING || table.count == TB_MAX_PIECES) return false;
+            table.pieces[table.count++] = make_piece(Color(c), pt);
+            table.pawns |= pt == PAWN;
+        }
+    }
+
+    table.size = 2 * (table.pawns ? 32 : 10) * 64;
+    for (int i = 2; i < table.count; ++i)
+        table.size *= piece_type(table.pieces[i]) == PAWN ? 48 : 64;
+    return true;
+}
+
+// ============================================================
+// Indexing
+// ============================================================
+
+// a1-d1-d4 triangle for the white king in pawnless tables
+static constexpr Square Triangle[10] = {
+    SQ_A1, SQ_B1, SQ_C1, SQ_D1, SQ_B2, SQ_C2, SQ_D2, SQ_C3, SQ_D3, SQ_D4
+};
+
+struct TriangleMap {
+    int8_t index[SQUARE_NB];
+};
+
+static constexpr TriangleMap make_triangle_map() {
+    TriangleMap m{};
+    for (auto& i : m.index) i = -1;
+    for (int i = 0; i < 10; ++i) m.index[Triangle[i]] = int8_t(i);
+    return m;
+}
+
+static constexpr TriangleMap TriangleIndex = make_triangle_map();
+
+static constexpr Square transpose(Square s) {
+    return Square(((s & 7) << 3) | (s >> 3));
+}
+
+static bool is_pawn(const Table& t, int i) {
+    return piece_type(t.pieces[i]) == PAWN;
+}
+
+// Identical pieces are interchangeable: keep each group sorted
+static void sort_groups(const Table& t, Square* sq) {
+    for (int i = 3; i < t.count; ++i)
+        for (int j = i; j > 2 && t.pieces[j] == t.pieces[j - 1] && sq[j] < sq[j - 1]; --j)
+            std::swap(sq[j], sq[j - 1]);
+}
+
+static uint64_t raw_index(const Table& t, Color stm, const Square* sq) {
+    uint64_t idx = stm;
+    if (t.pawns)
+        idx = idx * 32 + rank_of(sq[0]) * 4 + file_of(sq[0]);
+    else
+        idx = idx * 10 + TriangleIndex.index[sq[0]];
+    idx = idx * 64 + sq[1];
+    for (int i = 2; i < t.count; ++i)
+        idx = is_pawn(t, i) ? idx * 48 + (sq[i] - 8) : idx * 64 + sq[i];
+    return idx;
+}
+
+uint64_t encode(const Table& t, const Board& board, bool flip) {
+    Square sq[TB_MAX_PIECES];
+
+    // Squares in slot order, from the table's point of view
+    for (int i = 0; i < t.count; ) {
+        Piece p = t.pieces[i];
+        Color c = flip ? ~piece_color(p) : piece_color(p);
+        Bitboard bb = board.pieces(c, piece_type(p));
+        for (; i < t.count && t.pieces[i] == p && bb; ++i) {
+            Square s = pop_lsb(bb);
+            sq[i] = flip ? Square(s ^ 56) : s;
+        }
+    }
+    Color stm = flip ? ~board.side_to_move() : board.side_to_move();
+
+    // Bring the white king into its reduced region
+    auto apply = [&](auto fn) { for (int i = 0; i < t.count; ++i) sq[i] = fn(sq[i]); };
+    if (file_of(sq[0]) >= FILE_E) apply([](Square s) { return Square(s ^ 7); });
+
+    if (t.pawns) {
+        sort_groups(t, sq);
+        return raw_index(t, stm, sq);
+    }
+
+    if (rank_of(sq[0]) >= RANK_5) apply([](Square s) { return Square(s ^ 56); });
+    if (rank_of(sq[0]) > int(file_of(sq[0]))) apply(transpose);
+    sort_groups(t, sq);
+    uint64_t idx = raw_index(t, stm, sq);
+
+    // On the diagonal both the position and its transpose are in the
+    // triangle: take the smaller index
+    if (rank_of(sq[0]) == int(file_of(sq[0]))) {
+        apply(transpose);
+        sort_groups(t, sq);
+        idx = std::min(idx, raw_index(t, stm, sq));
+    }
+    return idx;
+}
+
+bool decode(const Table& t, uint64_t idx, Board& board) {
+    Square sq[TB_MAX_PIECES];
+    for (int i = t.count - 1; i >= 2; --i) {
+        if (is_pawn(t, i)) {
+            sq[i] = Square(idx % 48 + 8);
+            idx /= 48;
+        } else {
+            sq[i] = Square(idx % 64);
+            idx /= 64;
+        }
+    }
+    sq[1] = Square(idx % 64);
+    idx /= 64;
+    if (t.pawns) {
+        sq[0] = make_square(File(idx % 4), Rank(idx % 32 / 4));
+        idx /= 32;
+    } else {
+        sq[0] = Triangle[idx % 10];
+        idx /= 10;
+    }
+    Color stm = Color(idx);
+
+    Piece pieces[SQUARE_NB];
+    for (auto& p : pieces) p = NO_PIECE;
+    for (int i = 0; i < t.count; ++i) {
+        if (pieces[sq[i]] != NO_PIECE) return false;
+        pieces[sq[i]] = t.pieces[i];
+    }
+    board.set_position(pieces, stm, NO_CASTLING, SQ_NONE, 0, 1);
+    return true;
+}
+
+// ============================================================
+// Memory mapping
+// ============================================================
+struct MappedTable {
+    Table table;
+    void* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    ~MappedTable() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (base) munmap(base, length);
+#endif
+    }
+};
+
+static bool map_file(const std::string& path, MappedTable& m) {
+#ifdef _WIN32
+    m.file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m.file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m.file, &size)) return false;
+    m.mapping = CreateFileMappingA(m.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m.mapping) return false;
+    m.base = MapViewOfFile(m.mapping, FILE_MAP_READ, 0, 0, 0);
+    m.length = size_t(size.QuadPart);
+    return m.base != nullptr;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    m.base = p;
+    m.length = size_t(st.st_size);
+    return true;
+#endif
+}
+
+struct TableRef {
+    const Table* table;
+    bool flip;
+};
+
+static std::vector<std::unique_ptr<MappedTable>> g_tables;
+static std::unordered_map<uint64_t, TableRef> g_by_material;
+static int g_max_pieces = 0;
+
+static uint64_t material_key_of(const Table& t, bool flip) {
+    Piece pieces[SQUARE_NB];
+    for (auto& p : pieces) p = NO_PIECE;
+    for (int i = 0; i < t.count; ++i)
+        pieces[i] = flip ? make_piece(~piece_color(t.pieces[i]), piece_type(t.pieces[i])) : t.pieces[i];
+    Board board;
+    board.set_position(pieces, WHITE, NO_CASTLING, SQ_NONE, 0, 1);
+    return board.material_key();
+}
+
+static bool load_table(const std::string& path, const std::string& name) {
+    auto m = std::make_unique<MappedTable>();
+    if (!parse_table_name(name, m->table) || !map_file(path, *m)) return false;
+    if (m->length < sizeof(TBHeader)) return false;
+
+    TBHeader h;
+    std::memcpy(&h, m->base, sizeof(h));
+    if (std::memcmp(h.magic, "NOVATB\0\0", 8) != 0 || h.version != TB_VERSION
+        || h.count != uint32_t(m->table.count) || h.size != m->table.size
+        || m->length < sizeof(TBHeader) + h.size)
+        return false;
+    for (int i = 0; i < m->table.count; ++i)
+        if (h.pieces[i] != m->table.pieces[i]) return false;
+
+    Table& t = m->table;
+    t.data = static_cast<const uint8_t*>(m->base) + sizeof(TBHeader);
+    g_by_material[material_key_of(t, false)] = {&t, false};
+    g_by_material.emplace(material_key_of(t, true), TableRef{&t, true});
+    g_max_pieces = std::max(g_max_pieces, t.count);
+    g_tables.push_back(std::move(m));
+    return true;
+}
+
+int init(const std::string& dir) {
+    g_by_material.clear();
+    g_tables.clear();
+    g_max_pieces = 0;
+
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.path().extension() != ".nvtb") continue;
+        load_table(entry.path().string(), entry.path().stem().string());
+    }
+    return int(g_tables.size());
+}
+
+int max_pieces() {
+    return g_max_pieces;
+}
+
+bool probe(const Board& board, ProbeResult& result) {
+    auto it = g_by_material.find(board.material_key());
+    if (it == g_by_material.end()) return false;
+
+    const Table& t = *it->second.table;
+    uint8_t v = t.data[encode(t, board, it->second.flip)];
+    result.wdl = v == 0 ? 0 : (v & 1) ? -1 : 1;
+    result.dtm = v == 0 ? 0 : v - 1;
+    return true;
+}
+
+} // namespace tb
+} // namespace chess
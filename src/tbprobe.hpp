@@ -0,0 +1,91 @@
+#pragma once
+
+#include "board.hpp"
+#include <string>
+
+namespace chess {
+namespace tb {
+
+// ============================================================
+// Endgame tablebases generated locally by tools/tbgen.cpp.
+//
+// One byte per position: 0 = draw, otherwise the distance to mate in
+// plies + 1, odd when the side to move loses and even when it wins.
+// Positions have no castling rights and no en passant square.
+//
+// File "<name>.nvtb" (little endian):
+//   char     magic[8]    "NOVATB\0\0"
+//   uint32   version     TB_VERSION
+//   uint32   count       number of pieces
+//   uint8    pieces[4]   Piece codes in index order (see Table)
+//   uint64   size        number of entries
+//   uint8    padding[8]
+//   uint8    data[size]
+// ============================================================
+constexpr uint32_t TB_VERSION = 1;
+constexpr int TB_MAX_PIECES = 4;
+
+struct TBHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint8_t  pieces[TB_MAX_PIECES];
+    uint64_t size;
+    uint8_t  padding[8];
+};
+
+static_assert(sizeof(TBHeader) == 40, "TBHeader layout");
+
+// Index layout of one table. White is the first side of the name
+// ("KRvK": White has the rook). pieces[0] and pieces[1] are the kings,
+// followed by White's then Black's pieces, strongest first.
+//
+// The index is [stm][white king][black king][other pieces...]. The white
+// king is reduced by symmetry to the a1-d1-d4 triangle (10 squares) in
+// pawnless tables and to files A-D (32 squares) with pawns; pawns use
+// 48 slots (ranks 2-7).
+struct Table {
+    std::string    name;
+    Piece          pieces[TB_MAX_PIECES];
+    int            count = 0;
+    bool           pawns = false;
+    uint64_t       size = 0;
+    const uint8_t* data = nullptr;
+};
+
+// Set up a table's layout from its name, e.g. "KQvKR"
+bool parse_table_name(const std::string& name, Table& table);
+
+// Canonical table name for the board's material. 'flipped' is set when
+// Black holds the first side of the name.
+std::string table_name(const Board& board, bool& flipped);
+
+// Index of a position with the table's material. With 'flip', colours
+// are swapped and the board is mirrored vertically first. The index is
+// the same for every symmetric image of the position.
+uint64_t encode(const Table& table, const Board& board, bool flip = false);
+
+// Position at an index (no castling, no en passant). Returns false if
+// pieces overlap.
+bool decode(const Table& table, uint64_t index, Board& board);
+
+// ============================================================
+// Probing (memory-mapped, zero-copy)
+// ============================================================
+
+// Map every *.nvtb file in 'dir', replacing any previous set.
+// Returns the number of tables loaded.
+int init(const std::string& dir);
+int max_pieces();   // 0 if nothing is loaded
+
+struct ProbeResult {
+    int wdl;        // +1 win, 0 draw, -1 loss for the side to move
+    int dtm;        // plies to mate
+};
+
+// Probe the loaded tables. The board must have no castling rights and
+// no en passant square. Returns false if no table covers it.
+bool probe(const Board& board, ProbeResult& result);
+
+} // namespace tb
+} // namespace chess
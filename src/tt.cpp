@@ -0,0 +1,599 @@
+#include "tt.hpp"
+#include "board.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <fstream>
+#endif
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace chess {
+
+// ============================================================
+// Entry packing
+// ============================================================
+static constexpr uint64_t pack_entry(uint16_t key16, Move move, int score, int depth,
+                                     TTFlag flag, uint8_t generation) {
+    return uint64_t(key16)
+         | uint64_t(move.data) << 16
+         | uint64_t(uint16_t(int16_t(score))) << 32
+         | uint64_t(depth) << 48
+         | uint64_t(flag) << 56
+         | uint64_t(generation) << 58;
+}
+
+static constexpr uint16_t entry_key(uint64_t e)       { return uint16_t(e); }
+static constexpr Move     entry_move(uint64_t e)      { return Move(uint16_t(e >> 16)); }
+static constexpr int      entry_score(uint64_t e)     { return int16_t(uint16_t(e >> 32)); }
+static constexpr int      entry_depth(uint64_t e)     { return int(uint8_t(e >> 48)); }
+static constexpr TTFlag   entry_flag(uint64_t e)      { return TTFlag((e >> 56) & 3); }
+static constexpr uint8_t  entry_generation(uint64_t e) { return uint8_t(e >> 58); }
+
+// High 64 bits of a * b
+static inline uint64_t mul_hi64(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    return uint64_t((unsigned __int128)a * b >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return __umulh(a, b);
+#else
+    uint64_t a_lo = uint32_t(a), a_hi = a >> 32;
+    uint64_t b_lo = uint32_t(b), b_hi = b >> 32;
+    uint64_t c1 = (a_lo * b_lo) >> 32;
+    uint64_t c2 = a_hi * b_lo + c1;
+    uint64_t c3 = a_lo * b_hi + uint32_t(c2);
+    return a_hi * b_hi + (c2 >> 32) + (c3 >> 32);
+#endif
+}
+
+// Start of a shared-memory table, followed by the clusters (see below)
+struct TranspositionTable::SharedHeader {
+    std::atomic<uint32_t> ready;       // Set by the creator once initialised
+    std::atomic<uint32_t> attached;    // Processes using the segment
+    std::atomic<uint32_t> generation;
+    uint32_t version;
+    uint32_t cluster_bytes;
+    uint32_t padding0;
+    uint64_t cluster_count;
+    uint64_t zobrist;                  // zobrist_fingerprint() of the creator
+    uint8_t  padding[24];
+};
+
+// Run fn(begin, end) over [0, count) split into contiguous chunks, one
+// per thread. Each thread first-touches its own chunk, so on NUMA
+// machines the pages also end up spread over the searching nodes.
+template <typename Fn>
+static void parallel_for(size_t count, int threads, Fn fn) {
+    // Below 2 MB per thread, starting threads costs more than it saves
+    constexpr size_t MIN_CHUNK = 1 << 16;
+    size_t n = std::clamp<size_t>(count / MIN_CHUNK, 1, size_t(std::max(threads, 1)));
+    if (n == 1) {
+        fn(size_t(0), count);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    size_t chunk = count / n;
+    for (size_t i = 1; i < n; ++i)
+        workers.emplace_back(fn, i * chunk, i + 1 == n ? count : (i + 1) * chunk);
+    fn(size_t(0), chunk);
+    for (auto& w : workers) w.join();
+}
+
+// ============================================================
+// Allocation
+//
+// A large table costs a TLB miss on nearly every probe with 4 KB
+// pages. On Linux, try explicit hugetlb pages first (only available
+// if the administrator reserved them), then 2 MB aligned memory with
+// MADV_HUGEPAGE, then plain memory.
+// ============================================================
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+#ifdef __linux__
+// False if transparent huge pages are switched off system-wide
+static bool thp_available() {
+    std::ifstream f("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string line;
+    return std::getline(f, line) && line.find("[never]") == std::string::npos;
+}
+#endif
+
+bool TranspositionTable::allocate(size_t bytes, int threads) {
+    void* mem = nullptr;
+
+#ifdef __linux__
+    size_t rounded = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    mem = mmap(nullptr, rounded, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED) {
+        alloc_kind_ = ALLOC_MMAP;
+        alloc_bytes_ = rounded;
+        page_mode_ = "hugetlb pages";
+    } else {
+        mem = nullptr;
+    }
+#endif
+    if (!mem && (mem = std::aligned_alloc(HUGE_PAGE_SIZE, rounded))) {
+        alloc_kind_ = ALLOC_ALIGNED;
+        alloc_bytes_ = rounded;
+        page_mode_ = "normal pages";
+#ifdef MADV_HUGEPAGE
+        if (madvise(mem, rounded, MADV_HUGEPAGE) == 0 && thp_available())
+            page_mode_ = "transparent huge pages";
+#endif
+    }
+#endif
+
+    if (!mem && (mem = ::operator new(bytes, std::align_val_t(64), std::nothrow))) {
+        alloc_kind_ = ALLOC_NEW;
+        alloc_bytes_ = bytes;
+        page_mode_ = "normal pages";
+    }
+    if (!mem) return false;
+
+    // Construct the clusters, which also touches every page now
+    table_ = static_cast<Cluster*>(mem);
+    parallel_for(bytes / sizeof(Cluster), threads, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) new (&table_[i]) Cluster();
+    });
+    return true;
+}
+
+void TranspositionTable::deallocate() {
+    switch (alloc_kind_) {
+#ifdef __linux__
+    case ALLOC_MMAP:    munmap(table_, alloc_bytes_); break;
+    case ALLOC_ALIGNED: std::free(table_); break;
+#endif
+    case ALLOC_NEW:     ::operator delete(table_, std::align_val_t(64)); break;
+#ifndef _WIN32
+    case ALLOC_SHARED:
+        // The last process out removes the segment
+        if (shared_->attached.fetch_sub(1) == 1) shm_unlink(shm_path_.c_str());
+        munmap(shared_, alloc_bytes_);
+        shared_ = nullptr;
+        shm_path_.clear();
+        break;
+#endif
+    default: break;
+    }
+    table_ = nullptr;
+    cluster_count_ = 0;
+    alloc_kind_ = ALLOC_NONE;
+}
+
+TranspositionTable::~TranspositionTable() {
+    deallocate();
+}
+
+void TranspositionTable::resize(size_t mb, int threads) {
+    deallocate();
+
+    requested_mb_ = mb;
+
+    // Fall back to smaller sizes if the allocation fails. Fresh clusters
+    // are already empty, so no separate clear is needed.
+    size_t count = std::max<size_t>(1, mb * 1024 * 1024 / sizeof(Cluster));
+    if (!shared_name_.empty()) {
+        if (attach_shared(count, threads)) return;
+        shared_name_.clear();
+    }
+    while (!allocate(count * sizeof(Cluster), threads) && count > 1)
+        count /= 2;
+    cluster_count_ = table_ ? count : 0;
+    generation_ = 0;
+}
+
+void TranspositionTable::clear(int threads) {
+    // Other processes are still searching with a shared table
+    if (shared_) {
+        new_search();
+        return;
+    }
+    parallel_for(cluster_count_, threads, [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            for (auto& e : table_[i].entries) e.store(0, std::memory_order_relaxed);
+    });
+    generation_ = 0;
+}
+
+void TranspositionTable::new_search() {
+    // Processes sharing a table also share one generation counter
+    generation_ = shared_ ? uint8_t((shared_->generation.fetch_add(1) + 1) & 63)
+                          : uint8_t((generation_ + 1) & 63);
+}
+
+TranspositionTable::Cluster* TranspositionTable::cluster(uint64_t key) const {
+    return &table_[mul_hi64(key, cluster_count_)];
+}
+
+// ============================================================
+// Probe / store
+// ============================================================
+void TranspositionTable::prefetch(uint64_t key) const {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(cluster(key));
+#elif defined(_MSC_VER)
+    _mm_prefetch(reinterpret_cast<const char*>(cluster(key)), _MM_HINT_T0);
+#endif
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Cluster* c = cluster(key);
+    uint16_t key16 = uint16_t(key);
+
+    for (const auto& slot : c->entries) {
+        uint64_t e = slot.load(std::memory_order_relaxed);
+        if (entry_depth(e) && entry_key(e) == key16) {
+            entry.depth = entry_depth(e);
+            entry.score = entry_score(e);
+            entry.flag = entry_flag(e);
+            entry.best_move = entry_move(e);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, TTFlag flag, Move best) {
+    Cluster* c = cluster(key);
+    uint16_t key16 = uint16_t(key);
+    depth = std::clamp(depth, 1, 255);
+
+    // Same position or an empty slot first; otherwise replace the entry
+    // that is shallowest once older searches are discounted
+    int victim = 0;
+    int victim_worth = INT_MAX;
+    for (int i = 0; i < CLUSTER_SIZE; ++i) {
+        uint64_t e = c->entries[i].load(std::memory_order_relaxed);
+        if (!entry_depth(e)) {
+            victim = i;
+            break;
+        }
+        if (entry_key(e) == key16) {
+            // Keep a clearly deeper result from this search
+            if (entry_generation(e) == generation_ && flag != TT_EXACT && depth + 2 < entry_depth(e))
+                return;
+            if (!best) best = entry_move(e);
+            victim = i;
+            break;
+        }
+
+        int age = (64 + generation_ - entry_generation(e)) & 63;
+        int worth = entry_depth(e) - 8 * age;
+        if (worth < victim_worth) {
+            victim_worth = worth;
+            victim = i;
+        }
+    }
+
+    c->entries[victim].store(pack_entry(key16, best, score, depth, flag, generation_),
+                             std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t samples = std::min<size_t>(1000 / CLUSTER_SIZE, cluster_count_);
+    int used = 0;
+    for (size_t i = 0; i < samples; ++i) {
+        for (const auto& slot : table_[i].entries) {
+            uint64_t e = slot.load(std::memory_order_relaxed);
+            used += entry_depth(e) && entry_generation(e) == generation_;
+        }
+    }
+    return samples ? int(used * 1000 / (samples * CLUSTER_SIZE)) : 0;
+}
+
+// ============================================================
+// Save / load
+//
+// File layout: a 64-byte header, then the clusters exactly as they are
+// in memory. The Zobrist fingerprint guards against loading a table
+// written by a build that hashes positions differently.
+// ============================================================
+struct TTFileHeader {
+    char     magic[8];        // "NOVATT\0\0"
+    uint32_t version;
+    uint32_t cluster_bytes;
+    uint64_t cluster_count;
+    uint64_t zobrist;         // zobrist_fingerprint() of the writer
+    uint8_t  generation;
+    uint8_t  padding[31];
+};
+
+static_assert(sizeof(TTFileHeader) == 64, "TTFileHeader layout");
+
+static constexpr char     TT_FILE_MAGIC[8] = {'N', 'O', 'V', 'A', 'T', 'T', 0, 0};
+static constexpr uint32_t TT_FILE_VERSION = 1;
+
+// Hash of every key that goes into Board::key()
+static uint64_t zobrist_fingerprint() {
+    const ZobristKeys& z = zobrist();
+    uint64_t h = 0xCBF29CE484222325ULL;
+    auto mix = [&h](uint64_t k) { h = (h ^ k) * 0x100000001B3ULL; };
+    for (auto& ps : z.piece_square)
+        for (uint64_t k : ps) mix(k);
+    mix(z.side);
+    for (uint64_t k : z.castling) mix(k);
+    for (uint64_t k : z.en_passant) mix(k);
+    return h;
+}
+
+bool TranspositionTable::save(const std::string& path) const {
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+
+    TTFileHeader header{};
+    std::memcpy(header.magic, TT_FILE_MAGIC, sizeof(header.magic));
+    header.version = TT_FILE_VERSION;
+    header.cluster_bytes = sizeof(Cluster);
+    header.cluster_count = cluster_count_;
+    header.zobrist = zobrist_fingerprint();
+    header.generation = generation_;
+    bool ok = std::fwrite(&header, sizeof(header), 1, f) == 1;
+
+    // Entries are atomics: copy them out through a buffer
+    constexpr size_t BLOCK = 1 << 16;
+    auto buffer = std::make_unique<uint64_t[]>(BLOCK * CLUSTER_SIZE);
+    for (size_t i = 0; ok && i < cluster_count_; i += BLOCK) {
+        size_t n = std::min(BLOCK, cluster_count_ - i);
+        for (size_t j = 0; j < n; ++j)
+            for (int k = 0; k < CLUSTER_SIZE; ++k)
+                buffer[j * CLUSTER_SIZE + k] = table_[i + j].entries[k].load(std::memory_order_relaxed);
+        ok = std::fwrite(buffer.get(), sizeof(Cluster), n, f) == n;
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+namespace {
+
+// Read-only view of a whole file
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER length;
+        if (!GetFileSizeEx(file, &length) || length.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data) size = size_t(length.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                data = static_cast<const uint8_t*>(p);
+                size = size_t(st.st_size);
+                // One sequential pass: ask the kernel to read ahead
+                madvise(p, size, MADV_SEQUENTIAL);
+                madvise(p, size, MADV_WILLNEED);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
+
+} // namespace
+
+bool TranspositionTable::load(const std::string& path, int threads) {
+    // Would detach from the other processes' table
+    if (shared_) return false;
+
+    MappedFile file(path);
+    if (!file.data || file.size < sizeof(TTFileHeader)) return false;
+
+    // The count is checked by dividing the payload size, so a corrupt
+    // header cannot overflow a multiplication
+    TTFileHeader header;
+    std::memcpy(&header, file.data, sizeof(header));
+    size_t payload = file.size - sizeof(header);
+    if (std::memcmp(header.magic, TT_FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != TT_FILE_VERSION
+        || header.cluster_bytes != sizeof(Cluster)
+        || header.zobrist != zobrist_fingerprint()
+        || header.cluster_count == 0
+        || payload % sizeof(Cluster) != 0
+        || header.cluster_count != payload / sizeof(Cluster))
+        return false;
+
+    deallocate();
+    if (!allocate(payload, threads)) {
+        resize(std::max<size_t>(requested_mb_, 1), threads);
+        return false;
+    }
+    cluster_count_ = header.cluster_count;
+    generation_ = header.generation & 63;
+
+    // Later reallocations (SharedHash, a failed re-attach) keep this size
+    requested_mb_ = (payload + (1 << 20) - 1) >> 20;
+
+    // The threads fault in the file and the table in parallel
+    const uint8_t* src = file.data + sizeof(header);
+    parallel_for(cluster_count_, threads, [this, src](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uint64_t words[CLUSTER_SIZE];
+            std::memcpy(words, src + i * sizeof(Cluster), sizeof(words));
+            for (int k = 0; k < CLUSTER_SIZE; ++k)
+                table_[i].entries[k].store(words[k], std::memory_order_relaxed);
+        }
+    });
+    return true;
+}
+
+// ============================================================
+// Shared memory
+//
+// With a segment name set, the table lives in a POSIX shared-memory
+// object that every Nova process using that name maps. The first one
+// creates and sizes it, later ones take its size, and the last one to
+// detach removes it. Entries are single lock-free 64-bit words, so
+// writers in different processes are as safe as threads in one.
+//
+// A process that is killed never detaches, and the segment then
+// outlives all users until removed by hand (/dev/shm/nova-<name> on
+// Linux).
+// ============================================================
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared entries need lock-free atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared header needs lock-free atomics");
+
+bool TranspositionTable::set_shared(const std::string& name, int threads) {
+    static_assert(sizeof(SharedHeader) == 64, "SharedHeader layout");
+    if (name.find('/') != std::string::npos) return false;
+    deallocate();
+    shared_name_ = name;
+    resize(std::max<size_t>(requested_mb_, 1), threads);
+    return name.empty() || shared_;
+}
+
+#ifdef _WIN32
+
+bool TranspositionTable::attach_shared(size_t, int) {
+    return false;
+}
+
+#else
+
+bool TranspositionTable::attach_shared(size_t count, int threads) {
+    std::string path = "/nova-" + shared_name_;
+    auto pause = [] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); };
+
+    // Retry while another process is creating or removing the segment
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            size_t bytes = sizeof(SharedHeader) + count * sizeof(Cluster);
+            void* p = ftruncate(fd, off_t(bytes)) == 0
+                    ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                    : MAP_FAILED;
+            close(fd);
+            if (p == MAP_FAILED) {
+                shm_unlink(path.c_str());
+                return false;
+            }
+
+            auto* h = new (p) SharedHeader();
+            h->version = TT_FILE_VERSION;
+            h->cluster_bytes = sizeof(Cluster);
+            h->cluster_count = count;
+            h->zobrist = zobrist_fingerprint();
+            h->attached.store(1, std::memory_order_relaxed);
+            table_ = reinterpret_cast<Cluster*>(h + 1);
+            parallel_for(count, threads, [this](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) new (&table_[i]) Cluster();
+            });
+            h->ready.store(1, std::memory_order_release);
+
+            shared_ = h;
+            alloc_bytes_ = bytes;
+        } else {
+            if (errno != EEXIST) return false;
+            fd = shm_open(path.c_str(), O_RDWR, 0);
+            if (fd < 0) {
+                if (errno != ENOENT) return false;
+                continue;  // Removed since our create attempt
+            }
+
+            // The creator may not have sized the segment yet
+            struct stat st;
+            void* p = MAP_FAILED;
+            size_t bytes = 0;
+            if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(SharedHeader)) {
+                bytes = size_t(st.st_size);
+                p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            }
+            close(fd);
+            if (p == MAP_FAILED) {
+                pause();
+                continue;
+            }
+
+            auto* h = static_cast<SharedHeader*>(p);
+            for (int i = 0; i < 1000 && !h->ready.load(std::memory_order_acquire); ++i) pause();
+            if (!h->ready.load(std::memory_order_acquire)
+                || h->version != TT_FILE_VERSION
+                || h->cluster_bytes != sizeof(Cluster)
+                || h->zobrist != zobrist_fingerprint()
+                || (bytes - sizeof(SharedHeader)) % sizeof(Cluster) != 0
+                || h->cluster_count != (bytes - sizeof(SharedHeader)) / sizeof(Cluster)) {
+                munmap(p, bytes);
+                return false;
+            }
+
+            // Join, unless the last user is already removing it
+            uint32_t users = h->attached.load(std::memory_order_relaxed);
+            while (users && !h->attached.compare_exchange_weak(users, users + 1)) {}
+            if (!users) {
+                munmap(p, bytes);
+                pause();
+                continue;
+            }
+
+            shared_ = h;
+            table_ = reinterpret_cast<Cluster*>(h + 1);
+            alloc_bytes_ = bytes;
+            count = h->cluster_count;
+        }
+
+        alloc_kind_ = ALLOC_SHARED;
+        cluster_count_ = count;
+        page_mode_ = "shared memory";
+        shm_path_ = path;
+        generation_ = uint8_t(shared_->generation.load() & 63);
+        return true;
+    }
+    return false;
+}
+
+#endif
+
+} // namespace chess
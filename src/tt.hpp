@@ -0,0 +1,116 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+namespace chess {
+
+// ============================================================
+// Transposition table
+//
+// Each entry is one 64-bit word, read and written atomically, so
+// threads share the table without locks and never see torn entries:
+//
+//   bits  0-15  key      low 16 bits of the Zobrist key
+//   bits 16-31  move
+//   bits 32-47  score    (int16)
+//   bits 48-55  depth    0 = empty slot
+//   bits 56-57  bound    TTFlag
+//   bits 58-63  generation
+//
+// Four entries make a 32-byte cluster, so a probe touches one cache
+// line. The cluster is picked from the high bits of the key by a
+// multiply-high, which works for any table size; the key check uses
+// the low bits and is therefore independent of the index.
+// ============================================================
+enum TTFlag : uint8_t {
+    TT_EXACT,
+    TT_ALPHA,  // upper bound (failed low)
+    TT_BETA    // lower bound (failed high)
+};
+
+// Decoded copy of an entry
+struct TTEntry {
+    int      depth = 0;
+    int      score = 0;
+    TTFlag   flag = TT_EXACT;
+    Move     best_move{};
+};
+
+class TranspositionTable {
+public:
+    static constexpr int CLUSTER_SIZE = 4;
+
+    TranspositionTable() = default;
+    ~TranspositionTable();
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Reallocate to 'mb' megabytes (rounded down to whole clusters) and
+    // clear. Both split the table into chunks across 'threads' threads.
+    // A shared table is never wiped: clear() only ages it.
+    void resize(size_t mb, int threads = 1);
+    void clear(int threads = 1);
+
+    // Place the table in the shared-memory segment 'name', attaching to
+    // it if another process already created it (its size then wins over
+    // ours). An empty name returns to private memory. False if the
+    // segment cannot be used; the table is then private.
+    bool set_shared(const std::string& name, int threads = 1);
+
+    // Start a new search: older entries become preferred victims
+    void new_search();
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+
+    // Start loading a key's cluster into cache ahead of its probe
+    void prefetch(uint64_t key) const;
+    void store(uint64_t key, int depth, int score, TTFlag flag, Move best);
+
+    // Permille of sampled entries written during the current search
+    int hashfull() const;
+
+    size_t size_mb() const { return cluster_count_ * sizeof(Cluster) >> 20; }
+
+    // Write the table to a file, or replace it (size included) with one
+    // written earlier. Loading refuses files from another entry layout or
+    // Zobrist key set, and then keeps the current table.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, int threads = 1);
+
+    // Memory backing the table: "hugetlb pages", "transparent huge
+    // pages", "normal pages" or "shared memory"
+    const char* page_mode() const { return page_mode_; }
+
+private:
+    struct alignas(32) Cluster {
+        std::atomic<uint64_t> entries[CLUSTER_SIZE];
+    };
+
+    Cluster* cluster(uint64_t key) const;
+
+    // Large-page allocation with fallback; the memory is written once
+    // here so page faults do not land in the first search
+    bool allocate(size_t bytes, int threads);
+    bool attach_shared(size_t count, int threads);
+    void deallocate();
+
+    enum AllocKind : uint8_t { ALLOC_NONE, ALLOC_NEW, ALLOC_ALIGNED, ALLOC_MMAP, ALLOC_SHARED };
+
+    struct SharedHeader;
+
+    Cluster*      table_ = nullptr;
+    size_t        cluster_count_ = 0;
+    size_t        alloc_bytes_ = 0;
+    size_t        requested_mb_ = 0;
+    AllocKind     alloc_kind_ = ALLOC_NONE;
+    const char*   page_mode_ = "normal pages";
+    uint8_t       generation_ = 0;
+    std::string   shared_name_;     // Segment to use, empty for private memory
+    std::string   shm_path_;        // Segment currently attached
+    SharedHeader* shared_ = nullptr;
+};
+
+} // namespace chess
@@ -71,6 +71,14 @@ constexpr Square make_square(File f, Rank r) { return Square((r << 3) | f); }
 constexpr File   file_of(Square s) { return File(s & 7); }
 constexpr Rank   rank_of(Square s) { return Rank(s >> 3); }
 
+// Chebyshev (king-move) distance between two squares
+constexpr int distance(Square a, Square b) {
+    int df = file_of(a) - file_of(b), dr = rank_of(a) - rank_of(b);
+    df = df < 0 ? -df : df;
+    dr = dr < 0 ? -dr : dr;
+    return df > dr ? df : dr;
+}
+
 constexpr Bitboard square_bb(Square s) { return 1ULL << s; }
 
 // Square/string conversions
@@ -106,11 +114,56 @@ constexpr Bitboard RANK_6_BB = RANK_1_BB << 40;
 constexpr Bitboard RANK_7_BB = RANK_1_BB << 48;
 constexpr Bitboard RANK_8_BB = RANK_1_BB << 56;
 
+constexpr Bitboard DARK_SQUARES = 0xAA55AA55AA55AA55ULL;
+
 constexpr Bitboard file_bb(File f) { return FILE_A_BB << f; }
 constexpr Bitboard rank_bb(Rank r) { return RANK_1_BB << (8 * r); }
 constexpr Bitboard file_bb(Square s) { return file_bb(file_of(s)); }
 constexpr Bitboard rank_bb(Square s) { return rank_bb(rank_of(s)); }
 
+constexpr Rank relative_rank(Color c, Square s) {
+    return Rank(c == WHITE ? rank_of(s) : 7 - rank_of(s));
+}
+
+// ============================================================
+// Set-wise shifts and fills
+// ============================================================
+constexpr Bitboard shift_north(Bitboard b) { return b << 8; }
+constexpr Bitboard shift_south(Bitboard b) { return b >> 8; }
+constexpr Bitboard shift_east(Bitboard b)  { return (b & ~FILE_H_BB) << 1; }
+constexpr Bitboard shift_west(Bitboard b)  { return (b & ~FILE_A_BB) >> 1; }
+
+// One step towards the opponent of colour c
+constexpr Bitboard shift_up(Color c, Bitboard b) {
+    return c == WHITE ? shift_north(b) : shift_south(b);
+}
+
+constexpr Bitboard north_fill(Bitboard b) {
+    b |= b << 8; b |= b << 16; b |= b << 32;
+    return b;
+}
+constexpr Bitboard south_fill(Bitboard b) {
+    b |= b >> 8; b |= b >> 16; b |= b >> 32;
+    return b;
+}
+constexpr Bitboard file_fill(Bitboard b) { return north_fill(b) | south_fill(b); }
+
+// Squares strictly in front of / behind the given pieces of colour c
+constexpr Bitboard front_span(Color c, Bitboard b) {
+    return c == WHITE ? shift_north(north_fill(b)) : shift_south(south_fill(b));
+}
+constexpr Bitboard rear_span(Color c, Bitboard b) { return front_span(~c, b); }
+
+// Squares attacked by pawns of colour c, and every square they could
+// attack by advancing
+constexpr Bitboard pawn_attacks_bb(Color c, Bitboard pawns) {
+    Bitboard up = shift_up(c, pawns);
+    return shift_east(up) | shift_west(up);
+}
+constexpr Bitboard attack_span(Color c, Bitboard pawns) {
+    return front_span(c, shift_east(pawns) | shift_west(pawns));
+}
+
 // ============================================================
 // Bit manipulation
 // ============================================================
@@ -228,9 +281,39 @@ constexpr int VALUE_DRAW     = 0;
 constexpr int VALUE_MATE     = 32000;
 constexpr int VALUE_INFINITE = 32001;
 constexpr int VALUE_NONE     = 32002;
+constexpr int VALUE_KNOWN_WIN = 10000;
+
+constexpr int MAX_PLY = 256;
+
+constexpr int MATE_IN_MAX_PLY  =  VALUE_MATE - MAX_PLY;
+constexpr int MATED_IN_MAX_PLY = -VALUE_MATE + MAX_PLY;
+
+// ============================================================
+// Packed (midgame, endgame) score in one 32-bit integer:
+// mg in the low 16 bits, eg in the high 16 bits (signed)
+// ============================================================
+enum Score : int { SCORE_ZERO };
+
+constexpr Score make_score(int mg, int eg) {
+    return Score(int(unsigned(eg) << 16) + mg);
+}
+
+constexpr int mg_value(Score s) {
+    return int16_t(uint16_t(unsigned(s)));
+}
+
+// Round before the shift so a negative mg does not borrow from eg
+constexpr int eg_value(Score s) {
+    return int16_t(uint16_t((unsigned(s) + 0x8000) >> 16));
+}
 
-constexpr int MATE_IN_MAX_PLY  =  VALUE_MATE - 256;
-constexpr int MATED_IN_MAX_PLY = -VALUE_MATE + 256;
+constexpr Score operator+(Score a, Score b) { return Score(int(a) + int(b)); }
+constexpr Score operator-(Score a, Score b) { return Score(int(a) - int(b)); }
+constexpr Score operator-(Score s) { return Score(-int(s)); }
+constexpr Score operator*(Score s, int i) { return make_score(mg_value(s) * i, eg_value(s) * i); }
+constexpr Score operator*(int i, Score s) { return s * i; }
+constexpr Score& operator+=(Score& a, Score b) { return a = a + b; }
+constexpr Score& operator-=(Score& a, Score b) { return a = a - b; }
 
 constexpr int PieceValue[PIECE_TYPE_NB] = {
     0, 100, 320, 330, 500, 900, 20000
@@ -0,0 +1,389 @@
+// ============================================================
+// Nova tablebase generator
+//
+// Builds distance-to-mate tables for 3- and 4-piece endings by
+// retrograde analysis and writes them in the format read by
+// src/tbprobe.cpp. Tables are generated smallest first, so captures
+// and promotions can be resolved by probing the tables already written.
+//
+// Usage:
+//   tbgen <dir> [--pieces N] [--threads N] [TABLE...]
+//
+// Without TABLE names every table with up to N pieces (default 4) is
+// generated, e.g. "tbgen tb KQvK KRvK" builds just those two.
+//
+// Positions after a double push are treated as having no en passant
+// square, which only matters in KPvKP.
+// ============================================================
+
+#include "attacks.hpp"
+#include "bitbase.hpp"
+#include "board.hpp"
+#include "movegen.hpp"
+#include "tbprobe.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace chess;
+
+template <typename Fn>
+static void parallel_for(int threads, Fn fn) {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(fn, t);
+    for (auto& th : pool) th.join();
+}
+
+// ============================================================
+// Table list
+// ============================================================
+static std::string canonical_name(const std::vector<Piece>& pieces) {
+    Piece board[SQUARE_NB];
+    for (auto& p : board) p = NO_PIECE;
+    board[SQ_A1] = W_KING;
+    board[SQ_H8] = B_KING;
+    for (size_t i = 0; i < pieces.size(); ++i) board[SQ_B2 + i] = pieces[i];
+
+    Board b;
+    b.set_position(board, WHITE, NO_CASTLING, SQ_NONE, 0, 1);
+    bool flipped;
+    return tb::table_name(b, flipped);
+}
+
+static std::vector<std::string> all_tables(int max_pieces) {
+    std::set<std::string> names;
+    for (int pt1 = PAWN; pt1 <= QUEEN; ++pt1) {
+        names.insert(canonical_name({make_piece(WHITE, PieceType(pt1))}));
+        if (max_pieces < 4) continue;
+        for (int pt2 = PAWN; pt2 <= QUEEN; ++pt2) {
+            for (int c = 0; c < 2; ++c)
+                names.insert(canonical_name({make_piece(WHITE, PieceType(pt1)),
+                                             make_piece(Color(c), PieceType(pt2))}));
+        }
+    }
+
+    // Fewer pieces first, then fewer pawns: every capture or promotion
+    // leads into a table that is already done
+    std::vector<std::string> list(names.begin(), names.end());
+    auto order = [](const std::string& n) {
+        return std::make_pair(n.size(), std::count(n.begin(), n.end(), 'P'));
+    };
+    std::stable_sort(list.begin(), list.end(),
+                     [&](const std::string& a, const std::string& b) { return order(a) < order(b); });
+    return list;
+}
+
+// ============================================================
+// Retrograde analysis
+//
+// Every position is resolved at the level equal to its distance to
+// mate. A loss at level L makes each predecessor a win at L + 1; a win
+// at level L removes one child from each predecessor's count of
+// unresolved children, and a predecessor whose count reaches zero is a
+// loss one level later (or later still if a capture or promotion held
+// out longer). Whatever is never resolved is a draw.
+// ============================================================
+enum : uint8_t {
+    F_INVALID = 1,      // Not a canonical, legal position
+    F_NO_LOSS = 2       // Has a drawing or winning move: can never be lost
+};
+
+constexpr int MAX_LEVEL = 254;
+
+struct Generator {
+    const tb::Table& table;
+    int threads;
+
+    std::unique_ptr<std::atomic<uint8_t>[]> value;    // 0 = unresolved, else dtm + 1
+    std::unique_ptr<std::atomic<uint8_t>[]> pending;  // Children not yet known to win
+    std::vector<uint8_t> flags;
+    std::vector<uint8_t> exit_loss;                    // Level at which exits alone lose
+    std::vector<std::vector<uint32_t>> levels;
+
+    Generator(const tb::Table& t, int n)
+        : table(t), threads(n),
+          value(new std::atomic<uint8_t>[t.size]), pending(new std::atomic<uint8_t>[t.size]),
+          flags(t.size, 0), exit_loss(t.size, 0), levels(MAX_LEVEL + 1) {
+        for (uint64_t i = 0; i < t.size; ++i) {
+            value[i].store(0, std::memory_order_relaxed);
+            pending[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool run(std::string& error);
+
+private:
+    bool init_position(uint64_t idx, Board& board, std::vector<std::vector<uint32_t>>& out, std::string& error);
+    void predecessors(const Board& board, std::vector<uint32_t>& out) const;
+    void merge(std::vector<std::vector<std::vector<uint32_t>>>& local);
+};
+
+void Generator::merge(std::vector<std::vector<std::vector<uint32_t>>>& local) {
+    for (auto& per_thread : local)
+        for (int l = 0; l <= MAX_LEVEL; ++l) {
+            levels[l].insert(levels[l].end(), per_thread[l].begin(), per_thread[l].end());
+            per_thread[l].clear();
+        }
+}
+
+// Classify a position from its moves: mates, stalemates, and moves that
+// leave the table (captures, promotions) whose results are known already
+bool Generator::init_position(uint64_t idx, Board& board, std::vector<std::vector<uint32_t>>& out,
+                              std::string& error) {
+    if (!tb::decode(table, idx, board) || tb::encode(table, board) != idx) {
+        flags[idx] = F_INVALID;
+        return true;
+    }
+    Color us = board.side_to_move();
+    if (board.is_square_attacked(board.king_sq(~us), us)) {
+        flags[idx] = F_INVALID;
+        return true;
+    }
+
+    MoveList moves;
+    generate_moves(board, moves);
+    if (moves.count == 0) {
+        if (board.in_check()) out[0].push_back(uint32_t(idx));
+        else flags[idx] = F_NO_LOSS;
+        return true;
+    }
+
+    uint32_t children[256];
+    int n_children = 0;
+    int best_win = INT_MAX;     // Our dtm through an exit that loses for them
+    int worst_loss = 0;         // Our dtm if every exit wins for them
+    bool no_loss = false;
+
+    for (int i = 0; i < moves.count; ++i) {
+        Move m = moves[i];
+        bool exits = board.piece_on(m.to()) != NO_PIECE || m.is_promotion() || m.is_en_passant();
+        board.make_move(m);
+        if (exits) {
+            tb::ProbeResult r{0, 0};
+            if (popcount(board.occupied()) > 2 && !tb::probe(board, r)) {
+                bool flipped;
+                error = "missing table " + tb::table_name(board, flipped);
+                board.unmake_move(m);
+                return false;
+            }
+            if (r.wdl < 0) best_win = std::min(best_win, r.dtm + 1);
+            else if (r.wdl > 0) worst_loss = std::max(worst_loss, r.dtm + 1);
+            else no_loss = true;
+        } else {
+            uint32_t c = uint32_t(tb::encode(table, board));
+            if (std::find(children, children + n_children, c) == children + n_children)
+                children[n_children++] = c;
+        }
+        board.unmake_move(m);
+    }
+
+    if (best_win != INT_MAX) {
+        no_loss = true;
+        if (best_win <= MAX_LEVEL) out[best_win].push_back(uint32_t(idx));
+    }
+    flags[idx] = no_loss ? F_NO_LOSS : 0;
+    pending[idx].store(uint8_t(n_children), std::memory_order_relaxed);
+    exit_loss[idx] = uint8_t(std::min(worst_loss, MAX_LEVEL));
+    if (!no_loss && n_children == 0) out[exit_loss[idx]].push_back(uint32_t(idx));
+    return true;
+}
+
+// Positions one move earlier, by the side not to move, that stay in
+// this table: non-captures and non-promotions only
+void Generator::predecessors(const Board& board, std::vector<uint32_t>& out) const {
+    out.clear();
+    Color them = ~board.side_to_move();
+    Bitboard occ = board.occupied();
+
+    Piece pieces[SQUARE_NB];
+    for (int sq = 0; sq < 64; ++sq) pieces[sq] = board.piece_on(Square(sq));
+
+    Bitboard movers = board.pieces(them);
+    while (movers) {
+        Square to = pop_lsb(movers);
+        Piece p = pieces[to];
+        PieceType pt = piece_type(p);
+
+        Bitboard froms;
+        if (pt == PAWN) {
+            froms = EMPTY_BB;
+            Bitboard back = shift_up(~them, square_bb(to)) & ~occ;
+            if (back && relative_rank(them, lsb(back)) >= RANK_2) {
+                froms |= back;
+                if (relative_rank(them, to) == RANK_4)
+                    froms |= shift_up(~them, back) & ~occ;
+            }
+        } else {
+            froms = get_attacks(pt, to, occ) & ~occ;
+        }
+
+        while (froms) {
+            Square from = pop_lsb(froms);
+            pieces[to] = NO_PIECE;
+            pieces[from] = p;
+
+            Board prev;
+            prev.set_position(pieces, them, NO_CASTLING, SQ_NONE, 0, 1);
+            if (!prev.is_square_attacked(prev.king_sq(~them), them))
+                out.push_back(uint32_t(tb::encode(table, prev)));
+
+            pieces[from] = NO_PIECE;
+            pieces[to] = p;
+        }
+    }
+
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+bool Generator::run(std::string& error) {
+    using Levels = std::vector<std::vector<uint32_t>>;
+    std::vector<Levels> local(threads, Levels(MAX_LEVEL + 1));
+
+    // Initial classification
+    std::atomic<bool> failed{false};
+    parallel_for(threads, [&](int t) {
+        Board board;
+        std::string err;
+        uint64_t begin = table.size * t / threads, end = table.size * (t + 1) / threads;
+        for (uint64_t idx = begin; idx < end && !failed; ++idx) {
+            if (!init_position(idx, board, local[t], err)) {
+                failed = true;
+                error = err;
+            }
+        }
+    });
+    if (failed) return false;
+    merge(local);
+
+    // Resolve level by level
+    for (int level = 0; level <= MAX_LEVEL; ++level) {
+        const std::vector<uint32_t>& list = levels[level];
+        if (list.empty()) continue;
+
+        parallel_for(threads, [&](int t) {
+            Board board;
+            std::vector<uint32_t> preds;
+            size_t begin = list.size() * t / threads, end = list.size() * (t + 1) / threads;
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t idx = list[i];
+                uint8_t expected = 0;
+                if (!value[idx].compare_exchange_strong(expected, uint8_t(level + 1))) continue;
+                if (level == MAX_LEVEL) continue;
+
+                tb::decode(table, idx, board);
+                predecessors(board, preds);
+                for (uint32_t q : preds) {
+                    if (flags[q] & F_INVALID || value[q].load(std::memory_order_relaxed)) continue;
+                    if (level % 2 == 0) {
+                        local[t][level + 1].push_back(q);
+                    } else if (pending[q].fetch_sub(1) == 1 && !(flags[q] & F_NO_LOSS)) {
+                        local[t][std::max(level + 1, int(exit_loss[q]))].push_back(q);
+                    }
+                }
+            }
+        });
+        merge(local);
+        levels[level].clear();
+        levels[level].shrink_to_fit();
+    }
+    return true;
+}
+
+// ============================================================
+// Output
+// ============================================================
+static bool write_table(const std::string& path, const tb::Table& t, const Generator& gen) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+
+    tb::TBHeader h{};
+    std::memcpy(h.magic, "NOVATB\0\0", 8);
+    h.version = tb::TB_VERSION;
+    h.count = uint32_t(t.count);
+    for (int i = 0; i < t.count; ++i) h.pieces[i] = uint8_t(t.pieces[i]);
+    h.size = t.size;
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    std::vector<uint8_t> buf(1 << 20);
+    for (uint64_t i = 0; i < t.size; ) {
+        size_t n = size_t(std::min<uint64_t>(buf.size(), t.size - i));
+        for (size_t j = 0; j < n; ++j) buf[j] = gen.value[i + j].load(std::memory_order_relaxed);
+        out.write(reinterpret_cast<const char*>(buf.data()), std::streamsize(n));
+        i += n;
+    }
+    return bool(out);
+}
+
+// ============================================================
+// Main
+// ============================================================
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: tbgen <dir> [--pieces N] [--threads N] [TABLE...]" << std::endl;
+        return 1;
+    }
+
+    std::string dir = argv[1];
+    int max_pieces = tb::TB_MAX_PIECES;
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    std::vector<std::string> requested;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--pieces" && i + 1 < argc)       max_pieces = std::clamp(std::stoi(argv[++i]), 3, tb::TB_MAX_PIECES);
+        else if (arg == "--threads" && i + 1 < argc) threads = std::max(1, std::stoi(argv[++i]));
+        else requested.push_back(arg);
+    }
+
+    init_attacks();
+    init_bitbases();
+
+    std::vector<std::string> names = requested.empty() ? all_tables(max_pieces) : requested;
+    for (const std::string& name : names) {
+        tb::Table t;
+        if (!tb::parse_table_name(name, t)) {
+            std::cerr << "bad table name " << name << std::endl;
+            return 1;
+        }
+
+        // Pick up every table written so far for captures and promotions
+        tb::init(dir);
+
+        auto start = std::chrono::steady_clock::now();
+        Generator gen(t, threads);
+        std::string error;
+        if (!gen.run(error)) {
+            std::cerr << name << ": " << error << std::endl;
+            return 1;
+        }
+
+        std::string path = dir + "/" + name + ".nvtb";
+        if (!write_table(path, t, gen)) {
+            std::cerr << "cannot write " << path << std::endl;
+            return 1;
+        }
+
+        uint64_t wins = 0, losses = 0;
+        int longest = 0;
+        for (uint64_t i = 0; i < t.size; ++i) {
+            uint8_t v = gen.value[i].load(std::memory_order_relaxed);
+            if (!v) continue;
+            (v & 1 ? losses : wins)++;
+            longest = std::max(longest, v - 1);
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << name << ": " << t.size << " entries, " << wins << " wins, " << losses
+                  << " losses, longest mate " << longest << " plies, " << secs << " s" << std::endl;
+    }
+    return 0;
+}
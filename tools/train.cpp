@@ -0,0 +1,418 @@
+// ============================================================
+// Nova NNUE trainer
+//
+// Trains the (768 -> L1) x 2 -> 1 network used by src/nnue.cpp
+// on CPU with all cores and writes a quantized .nnue file.
+//
+// Usage:
+//   train <data> <out.nnue> [--epochs N] [--batch N] [--lr X]
+//         [--threads N] [--hidden N] [--lambda X] [--optimizer adam|sgd]
+//
+// <data> is either a text file with lines "<FEN> | <score> | <result>"
+// or a binary file of PackedPosition records (extension .bin).
+// ============================================================
+
+#include "attacks.hpp"
+#include "board.hpp"
+#include "nnue.hpp"
+#include "packed.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace chess;
+
+static constexpr int MAX_FEATURES = 32;
+
+// ============================================================
+// Training data (white-perspective features, stm-relative targets)
+// ============================================================
+struct Dataset {
+    std::vector<uint16_t> features;   // [pos][MAX_FEATURES]
+    std::vector<uint8_t>  count;
+    std::vector<uint8_t>  stm;
+    std::vector<float>    score;      // Side to move's point of view, in cp
+    std::vector<float>    result;     // Side to move's point of view, 0 / 0.5 / 1
+
+    size_t size() const { return count.size(); }
+
+    void resize(size_t n) {
+        features.resize(n * MAX_FEATURES);
+        count.resize(n);
+        stm.resize(n);
+        score.resize(n);
+        result.resize(n);
+    }
+
+    void set(size_t i, const Board& board, int white_score, int white_result) {
+        int n = 0;
+        Bitboard occ = board.occupied();
+        while (occ && n < MAX_FEATURES) {
+            Square sq = pop_lsb(occ);
+            features[i * MAX_FEATURES + n++] = uint16_t(nnue::feature_index(WHITE, board.piece_on(sq), sq));
+        }
+        count[i] = uint8_t(n);
+
+        bool white = board.side_to_move() == WHITE;
+        stm[i] = uint8_t(board.side_to_move());
+        score[i] = float(white ? white_score : -white_score);
+        result[i] = (white ? white_result : 2 - white_result) / 2.0f;
+    }
+
+    // Drop the entries whose keep flag is 0, preserving order
+    void compact(const std::vector<uint8_t>& keep) {
+        size_t n = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            if (!keep[i]) continue;
+            if (n != i) {
+                std::copy_n(&features[i * MAX_FEATURES], MAX_FEATURES, &features[n * MAX_FEATURES]);
+                count[n] = count[i];
+                stm[n] = stm[i];
+                score[n] = score[i];
+                result[n] = result[i];
+            }
+            ++n;
+        }
+        resize(n);
+    }
+};
+
+// Same piece seen from Black's side: swap colours and flip ranks
+static inline int flip_feature(int f) {
+    return (f ^ 56) + (f < 384 ? 384 : -384);
+}
+
+template <typename Fn>
+static void parallel_for(int threads, Fn fn) {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(fn, t);
+    for (auto& th : pool) th.join();
+}
+
+// Invalid packed records (or results) are skipped and counted in
+// 'rejected'
+static bool load_dataset(const std::string& path, Dataset& data, size_t& rejected, int threads) {
+    bool binary = path.size() > 4 && path.substr(path.size() - 4) == ".bin";
+    rejected = 0;
+
+    if (binary) {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) return false;
+        size_t n = size_t(in.tellg()) / sizeof(PackedPosition);
+        std::vector<PackedPosition> raw(n);
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(raw.data()), n * sizeof(PackedPosition));
+        data.resize(n);
+
+        std::vector<uint8_t> keep(n, 1);
+        parallel_for(threads, [&](int t) {
+            Board board;
+            for (size_t i = t; i < n; i += threads) {
+                if (raw[i].result <= 2 && unpack_position(raw[i], board)) data.set(i, board, raw[i].score, raw[i].result);
+                else keep[i] = 0;
+            }
+        });
+        rejected = size_t(std::count(keep.begin(), keep.end(), 0));
+        if (rejected) data.compact(keep);
+        return true;
+    }
+
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line, fen;
+    int score, result;
+    Board board;
+    size_t i = 0;
+    while (std::getline(in, line)) {
+        if (!parse_scored_line(line, fen, score, result)) continue;
+        board.set_fen(fen);
+        if (i == data.size()) data.resize(std::max<size_t>(1024, i * 2));
+        data.set(i++, board, score, result);
+    }
+    data.resize(i);
+    return true;
+}
+
+// ============================================================
+// Float network and optimizer state
+// ============================================================
+struct Params {
+    int l1;
+    std::vector<float> ft_w;    // [768][l1]
+    std::vector<float> ft_b;    // [l1]
+    std::vector<float> out_w;   // [2][l1]
+    float out_b = 0.0f;
+
+    explicit Params(int hidden)
+        : l1(hidden), ft_w(size_t(nnue::INPUTS) * hidden, 0.0f), ft_b(hidden, 0.0f), out_w(2 * hidden, 0.0f) {}
+};
+
+struct Gradients {
+    std::vector<float>   ft_w;
+    std::vector<uint8_t> touched;   // Feature rows with a non-zero gradient
+    std::vector<float>   ft_b;
+    std::vector<float>   out_w;
+    float out_b = 0.0f;
+    double loss = 0.0;
+
+    explicit Gradients(int l1)
+        : ft_w(size_t(nnue::INPUTS) * l1, 0.0f), touched(nnue::INPUTS, 0), ft_b(l1, 0.0f), out_w(2 * l1, 0.0f) {}
+};
+
+struct Optimizer {
+    bool adam = true;
+    float lr = 0.001f;
+    float beta1 = 0.9f, beta2 = 0.999f, eps = 1e-8f;
+    int step = 0;
+
+    void update(float* w, float* m, float* v, const float* g, size_t n, float lo, float hi) const {
+        float c1 = 1.0f - std::pow(beta1, float(step));
+        float c2 = 1.0f - std::pow(beta2, float(step));
+        for (size_t i = 0; i < n; ++i) {
+            float delta;
+            if (adam) {
+                m[i] = beta1 * m[i] + (1.0f - beta1) * g[i];
+                v[i] = beta2 * v[i] + (1.0f - beta2) * g[i] * g[i];
+                delta = lr * (m[i] / c1) / (std::sqrt(v[i] / c2) + eps);
+            } else {
+                delta = lr * g[i];
+            }
+            w[i] = std::clamp(w[i] - delta, lo, hi);
+        }
+    }
+};
+
+// ============================================================
+// Forward / backward for one position
+// ============================================================
+static void train_position(const Params& p, const Dataset& data, size_t i, float lambda,
+                           Gradients& g, std::vector<float>& acc) {
+    const int l1 = p.l1;
+    float* acc_us = acc.data();
+    float* acc_them = acc.data() + l1;
+    const uint16_t* feats = &data.features[i * MAX_FEATURES];
+    int n = data.count[i];
+    bool black = data.stm[i] == BLACK;
+
+    std::copy(p.ft_b.begin(), p.ft_b.end(), acc_us);
+    std::copy(p.ft_b.begin(), p.ft_b.end(), acc_them);
+    for (int k = 0; k < n; ++k) {
+        int fw = feats[k], fb = flip_feature(fw);
+        const float* col_us = &p.ft_w[size_t(black ? fb : fw) * l1];
+        const float* col_them = &p.ft_w[size_t(black ? fw : fb) * l1];
+        for (int j = 0; j < l1; ++j) {
+            acc_us[j] += col_us[j];
+            acc_them[j] += col_them[j];
+        }
+    }
+
+    float out = p.out_b;
+    for (int j = 0; j < l1; ++j) {
+        out += std::clamp(acc_us[j], 0.0f, 1.0f) * p.out_w[j];
+        out += std::clamp(acc_them[j], 0.0f, 1.0f) * p.out_w[l1 + j];
+    }
+
+    // Output is in units of OUTPUT_SCALE centipawns; sigmoid maps to a score
+    float pred = 1.0f / (1.0f + std::exp(-out));
+    float target = lambda * (1.0f / (1.0f + std::exp(-data.score[i] / nnue::OUTPUT_SCALE)))
+                 + (1.0f - lambda) * data.result[i];
+    float err = pred - target;
+    g.loss += double(err) * err;
+
+    float d_out = 2.0f * err * pred * (1.0f - pred);
+    g.out_b += d_out;
+    for (int j = 0; j < l1; ++j) {
+        float h_us = std::clamp(acc_us[j], 0.0f, 1.0f);
+        float h_them = std::clamp(acc_them[j], 0.0f, 1.0f);
+        g.out_w[j] += d_out * h_us;
+        g.out_w[l1 + j] += d_out * h_them;
+
+        // Reuse the accumulators for the gradient w.r.t. the pre-activations
+        acc_us[j] = (acc_us[j] > 0.0f && acc_us[j] < 1.0f) ? d_out * p.out_w[j] : 0.0f;
+        acc_them[j] = (acc_them[j] > 0.0f && acc_them[j] < 1.0f) ? d_out * p.out_w[l1 + j] : 0.0f;
+        g.ft_b[j] += acc_us[j] + acc_them[j];
+    }
+
+    // Sparse: only the rows of active features receive a gradient
+    for (int k = 0; k < n; ++k) {
+        int fw = feats[k], fb = flip_feature(fw);
+        int f_us = black ? fb : fw, f_them = black ? fw : fb;
+        float* row_us = &g.ft_w[size_t(f_us) * l1];
+        float* row_them = &g.ft_w[size_t(f_them) * l1];
+        for (int j = 0; j < l1; ++j) {
+            row_us[j] += acc_us[j];
+            row_them[j] += acc_them[j];
+        }
+        g.touched[f_us] = g.touched[f_them] = 1;
+    }
+}
+
+// ============================================================
+// Quantization
+// ============================================================
+static bool write_quantized(const std::string& path, const Params& p) {
+    std::vector<int16_t> ft_w(p.ft_w.size()), ft_b(p.l1);
+    std::vector<int8_t> out_w(2 * p.l1);
+    for (size_t i = 0; i < p.ft_w.size(); ++i)
+        ft_w[i] = int16_t(std::lround(std::clamp(p.ft_w[i] * nnue::QA, -32767.0f, 32767.0f)));
+    for (int j = 0; j < p.l1; ++j)
+        ft_b[j] = int16_t(std::lround(std::clamp(p.ft_b[j] * nnue::QA, -32767.0f, 32767.0f)));
+    for (int j = 0; j < 2 * p.l1; ++j)
+        out_w[j] = int8_t(std::lround(std::clamp(p.out_w[j] * nnue::QB, -127.0f, 127.0f)));
+    int32_t out_b = int32_t(std::lround(p.out_b * nnue::QA * nnue::QB));
+    return nnue::save_network(path, p.l1, ft_w.data(), ft_b.data(), out_w.data(), out_b);
+}
+
+// ============================================================
+// Main
+// ============================================================
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: train <data> <out.nnue> [--epochs N] [--batch N] [--lr X] "
+                     "[--threads N] [--hidden N] [--lambda X] [--optimizer adam|sgd]" << std::endl;
+        return 1;
+    }
+
+    std::string data_path = argv[1], out_path = argv[2];
+    int epochs = 10, batch = 16384, hidden = 256;
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    float lambda = 0.75f;
+    Optimizer opt;
+
+    for (int a = 3; a + 1 < argc; a += 2) {
+        std::string k = argv[a], v = argv[a + 1];
+        if (k == "--epochs") epochs = std::stoi(v);
+        else if (k == "--batch") batch = std::stoi(v);
+        else if (k == "--lr") opt.lr = std::stof(v);
+        else if (k == "--threads") threads = std::max(1, std::stoi(v));
+        else if (k == "--hidden") hidden = std::stoi(v);
+        else if (k == "--lambda") lambda = std::stof(v);
+        else if (k == "--optimizer") opt.adam = (v != "sgd");
+    }
+    if (hidden % 32 != 0 || hidden > nnue::MAX_L1) {
+        std::cerr << "hidden size must be a multiple of 32 and at most " << nnue::MAX_L1 << std::endl;
+        return 1;
+    }
+
+    init_attacks();
+
+    Dataset data;
+    size_t rejected = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    if (!load_dataset(data_path, data, rejected, threads) || data.size() == 0) {
+        std::cerr << "failed to load " << data_path << std::endl;
+        return 1;
+    }
+    auto load_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    std::cout << "loaded " << data.size() << " positions in " << load_ms << " ms, "
+              << threads << " threads" << std::endl;
+    if (rejected)
+        std::cout << "skipped " << rejected << " invalid records" << std::endl;
+
+    // Initialization
+    Params params(hidden);
+    std::mt19937 rng(0xC0FFEE);
+    std::normal_distribution<float> ft_dist(0.0f, 1.0f / std::sqrt(float(MAX_FEATURES)));
+    std::normal_distribution<float> out_dist(0.0f, 1.0f / std::sqrt(float(2 * hidden)));
+    for (auto& w : params.ft_w) w = ft_dist(rng);
+    for (auto& w : params.out_w) w = out_dist(rng);
+
+    Params m(hidden), v(hidden);   // Adam moments
+    std::vector<Gradients> grads(threads, Gradients(hidden));
+    Gradients total(hidden);
+
+    const float out_limit = 127.0f / nnue::QB;
+    // An accumulator is the bias plus up to MAX_FEATURES weights: give
+    // each an equal whole share of the int16 range after quantization
+    const float ft_limit = std::floor(32767.0f / (MAX_FEATURES + 1)) / nnue::QA;
+
+    std::vector<size_t> order(data.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        std::shuffle(order.begin(), order.end(), rng);
+        auto start = std::chrono::steady_clock::now();
+        double epoch_loss = 0.0;
+
+        for (size_t begin = 0; begin < order.size(); begin += batch) {
+            size_t end = std::min(order.size(), begin + size_t(batch));
+
+            // Each thread accumulates the gradient of its slice of the batch
+            parallel_for(threads, [&](int t) {
+                Gradients& g = grads[t];
+                std::vector<float> acc(2 * hidden);
+                for (size_t i = begin + t; i < end; i += threads)
+                    train_position(params, data, order[i], lambda, g, acc);
+            });
+
+            opt.step++;
+            float scale = 1.0f / float(end - begin);
+
+            // Reduce and update the feature transformer row by row, in
+            // parallel; rows no thread touched are skipped entirely
+            parallel_for(threads, [&](int t) {
+                std::vector<float> row(hidden);
+                for (int f = t; f < nnue::INPUTS; f += threads) {
+                    bool any = false;
+                    for (auto& g : grads) any |= g.touched[f] != 0;
+                    if (!any) continue;
+
+                    std::fill(row.begin(), row.end(), 0.0f);
+                    for (auto& g : grads) {
+                        if (!g.touched[f]) continue;
+                        float* src = &g.ft_w[size_t(f) * hidden];
+                        for (int j = 0; j < hidden; ++j) {
+                            row[j] += src[j] * scale;
+                            src[j] = 0.0f;
+                        }
+                        g.touched[f] = 0;
+                    }
+                    size_t off = size_t(f) * hidden;
+                    opt.update(&params.ft_w[off], &m.ft_w[off], &v.ft_w[off], row.data(), hidden,
+                               -ft_limit, ft_limit);
+                }
+            });
+
+            // Dense small layers
+            std::fill(total.ft_b.begin(), total.ft_b.end(), 0.0f);
+            std::fill(total.out_w.begin(), total.out_w.end(), 0.0f);
+            total.out_b = 0.0f;
+            for (auto& g : grads) {
+                for (int j = 0; j < hidden; ++j) total.ft_b[j] += g.ft_b[j] * scale;
+                for (int j = 0; j < 2 * hidden; ++j) total.out_w[j] += g.out_w[j] * scale;
+                total.out_b += g.out_b * scale;
+                epoch_loss += g.loss;
+                std::fill(g.ft_b.begin(), g.ft_b.end(), 0.0f);
+                std::fill(g.out_w.begin(), g.out_w.end(), 0.0f);
+                g.out_b = 0.0f;
+                g.loss = 0.0;
+            }
+            opt.update(params.ft_b.data(), m.ft_b.data(), v.ft_b.data(), total.ft_b.data(), hidden,
+                       -ft_limit, ft_limit);
+            opt.update(params.out_w.data(), m.out_w.data(), v.out_w.data(), total.out_w.data(), 2 * hidden,
+                       -out_limit, out_limit);
+            opt.update(&params.out_b, &m.out_b, &v.out_b, &total.out_b, 1, -1e6f, 1e6f);
+        }
+
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "epoch " << epoch
+                  << " loss " << epoch_loss / double(data.size())
+                  << " pos/s " << int64_t(double(data.size()) / std::max(secs, 1e-9))
+                  << std::endl;
+
+        if (!write_quantized(out_path, params)) {
+            std::cerr << "failed to write " << out_path << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "wrote " << out_path << std::endl;
+    return 0;
+}
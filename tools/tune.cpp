@@ -0,0 +1,404 @@
+// ============================================================
+// Nova Texel tuner
+//
+// Tunes the classical evaluation weights in src/eval_params.hpp
+// against game results with gradient descent (Adam). Every position
+// is traced once; the cached sparse traces make each iteration a
+// simple dot product, computed in parallel across threads.
+//
+// Usage:
+//   tune <data> <out.hpp> [--iterations N] [--lr X] [--threads N] [--k X]
+//
+// <data> lines are any of
+//   <FEN> | <score> | <result>        (result 1.0 / 0.5 / 0.0)
+//   <EPD> c9 "1-0";                   (1-0 / 1/2-1/2 / 0-1)
+//   <FEN> [1.0]
+// with the result from White's point of view.
+// ============================================================
+
+#include "attacks.hpp"
+#include "bitbase.hpp"
+#include "board.hpp"
+#include "eval.hpp"
+#include "eval_params.hpp"
+#include "material.hpp"
+#include "packed.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace chess;
+
+// ============================================================
+// Weight layout: every term is a (mg, eg) pair
+// ============================================================
+enum : int {
+    W_MATERIAL  = 0,                      // PAWN..QUEEN
+    W_PSQT      = W_MATERIAL + 5,         // [PAWN..KING][64]
+    W_DOUBLED   = W_PSQT + 6 * 64,
+    W_ISOLATED,
+    W_BACKWARD,
+    W_CONNECTED,
+    W_PASSED,                             // [RANK_NB]
+    W_MOBILITY  = W_PASSED + RANK_NB,
+    W_KING_ATTACK,
+    W_BISHOP_PAIR,
+    W_COUNT
+};
+
+static const Score* const Pst[PIECE_TYPE_NB] = {
+    nullptr, params::PawnPST, params::KnightPST, params::BishopPST, params::RookPST, params::QueenPST, params::KingPST
+};
+
+struct Weights {
+    double mg[W_COUNT];
+    double eg[W_COUNT];
+};
+
+static void set_weight(Weights& w, int index, Score s) {
+    w.mg[index] = mg_value(s);
+    w.eg[index] = eg_value(s);
+}
+
+static Weights initial_weights() {
+    Weights w{};
+    for (int pt = PAWN; pt <= QUEEN; ++pt)
+        set_weight(w, W_MATERIAL + pt - 1, params::Material[pt]);
+    for (int pt = PAWN; pt <= KING; ++pt)
+        for (int sq = 0; sq < 64; ++sq)
+            set_weight(w, W_PSQT + (pt - 1) * 64 + sq, Pst[pt][sq]);
+    set_weight(w, W_DOUBLED, params::Doubled);
+    set_weight(w, W_ISOLATED, params::Isolated);
+    set_weight(w, W_BACKWARD, params::Backward);
+    set_weight(w, W_CONNECTED, params::Connected);
+    for (int r = 0; r < RANK_NB; ++r)
+        set_weight(w, W_PASSED + r, params::PassedPawn[r]);
+    set_weight(w, W_MOBILITY, params::Mobility);
+    set_weight(w, W_KING_ATTACK, params::KingAttack);
+    set_weight(w, W_BISHOP_PAIR, params::BishopPair);
+    return w;
+}
+
+// ============================================================
+// Cached traces
+// ============================================================
+struct Coef {
+    uint16_t index;
+    int16_t  value;     // White count minus Black count
+};
+
+struct TunePosition {
+    uint32_t begin, end;  // Range in the coefficient array
+    float    result;      // White's point of view
+    uint8_t  phase;
+    uint8_t  scale;
+};
+
+struct Dataset {
+    std::vector<TunePosition> positions;
+    std::vector<Coef> coefs;
+};
+
+static void add_coef(std::vector<Coef>& out, int index, const int (&v)[COLOR_NB]) {
+    int d = v[WHITE] - v[BLACK];
+    if (d) out.push_back({uint16_t(index), int16_t(d)});
+}
+
+static bool trace_position(const Board& board, float result, Dataset& data) {
+    EvalTrace t;
+    evaluate_trace(board, t);
+    if (t.known_ending) return false;
+
+    TunePosition p;
+    p.begin = uint32_t(data.coefs.size());
+    for (int pt = PAWN; pt <= QUEEN; ++pt)
+        add_coef(data.coefs, W_MATERIAL + pt - 1, t.material[pt]);
+    for (int pt = PAWN; pt <= KING; ++pt)
+        for (int sq = 0; sq < 64; ++sq)
+            add_coef(data.coefs, W_PSQT + (pt - 1) * 64 + sq, t.psqt[pt][sq]);
+    add_coef(data.coefs, W_DOUBLED, t.doubled);
+    add_coef(data.coefs, W_ISOLATED, t.isolated);
+    add_coef(data.coefs, W_BACKWARD, t.backward);
+    add_coef(data.coefs, W_CONNECTED, t.connected);
+    for (int r = 0; r < RANK_NB; ++r)
+        add_coef(data.coefs, W_PASSED + r, t.passed[r]);
+    add_coef(data.coefs, W_MOBILITY, t.mobility);
+    add_coef(data.coefs, W_KING_ATTACK, t.king_attacks);
+    add_coef(data.coefs, W_BISHOP_PAIR, t.bishop_pair);
+    p.end = uint32_t(data.coefs.size());
+    p.result = result;
+    p.phase = uint8_t(t.phase);
+    p.scale = uint8_t(t.scale);
+    data.positions.push_back(p);
+    return true;
+}
+
+static bool parse_line(const std::string& line, std::string& fen, float& result) {
+    int score, r;
+    if (parse_scored_line(line, fen, score, r)) {
+        result = r / 2.0f;
+        return true;
+    }
+
+    std::string res;
+    size_t pos;
+    if ((pos = line.find("c9 \"")) != std::string::npos) {
+        fen = line.substr(0, pos);
+        res = line.substr(pos + 4, line.find('"', pos + 4) - pos - 4);
+    } else if ((pos = line.find('[')) != std::string::npos) {
+        fen = line.substr(0, pos);
+        res = line.substr(pos + 1, line.find(']', pos) - pos - 1);
+    } else {
+        return false;
+    }
+
+    if (res == "1-0" || res == "1.0" || res == "1")            result = 1.0f;
+    else if (res == "0-1" || res == "0.0" || res == "0")       result = 0.0f;
+    else if (res == "1/2-1/2" || res == "0.5")                 result = 0.5f;
+    else return false;
+    return true;
+}
+
+// ============================================================
+// Model
+// ============================================================
+static double linear_eval(const Dataset& data, const TunePosition& p, const Weights& w) {
+    double mg = 0.0, eg = 0.0;
+    for (uint32_t i = p.begin; i < p.end; ++i) {
+        mg += data.coefs[i].value * w.mg[data.coefs[i].index];
+        eg += data.coefs[i].value * w.eg[data.coefs[i].index];
+    }
+    eg *= p.scale / double(SCALE_FACTOR_NORMAL);
+    return (mg * p.phase + eg * (TOTAL_PHASE - p.phase)) / TOTAL_PHASE;
+}
+
+static double sigmoid(double k, double e) {
+    return 1.0 / (1.0 + std::pow(10.0, -k * e / 400.0));
+}
+
+template <typename Fn>
+static void parallel_for(int threads, Fn fn) {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(fn, t);
+    for (auto& th : pool) th.join();
+}
+
+static double total_error(const Dataset& data, const Weights& w, double k, int threads) {
+    std::vector<double> partial(threads, 0.0);
+    parallel_for(threads, [&](int t) {
+        double sum = 0.0;
+        for (size_t i = t; i < data.positions.size(); i += threads) {
+            const TunePosition& p = data.positions[i];
+            double d = p.result - sigmoid(k, linear_eval(data, p, w));
+            sum += d * d;
+        }
+        partial[t] = sum;
+    });
+    double sum = 0.0;
+    for (double v : partial) sum += v;
+    return sum / double(data.positions.size());
+}
+
+// Find the sigmoid scale that best fits the current weights
+static double compute_k(const Dataset& data, const Weights& w, int threads) {
+    double best_k = 1.0, best = total_error(data, w, best_k, threads);
+    for (double step = 0.5; step > 0.001; step /= 4) {
+        bool improved = true;
+        while (improved) {
+            improved = false;
+            for (double k : {best_k - step, best_k + step}) {
+                if (k <= 0) continue;
+                double e = total_error(data, w, k, threads);
+                if (e < best) { best = e; best_k = k; improved = true; }
+            }
+        }
+    }
+    return best_k;
+}
+
+// ============================================================
+// Output (same layout as src/eval_params.hpp)
+// ============================================================
+static std::string score_string(const Weights& w, int index) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "S(%4d,%4d)", int(std::lround(w.mg[index])), int(std::lround(w.eg[index])));
+    return buf;
+}
+
+static void write_table(std::FILE* f, const char* name, const Weights& w, int base) {
+    std::fprintf(f, "inline constexpr Score %s[64] = {\n", name);
+    for (int r = 0; r < 8; ++r) {
+        std::fprintf(f, "   ");
+        for (int c = 0; c < 8; ++c) std::fprintf(f, " %s,", score_string(w, base + r * 8 + c).c_str());
+        std::fprintf(f, "\n");
+    }
+    std::fprintf(f, "};\n");
+}
+
+static void write_term(std::FILE* f, const char* name, const Weights& w, int index) {
+    std::fprintf(f, "inline constexpr Score %s = %s;\n", name, score_string(w, index).c_str());
+}
+
+static bool write_params(const std::string& path, const Weights& w) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    std::fprintf(f,
+        "#pragma once\n\n"
+        "#include \"types.hpp\"\n\n"
+        "// ============================================================\n"
+        "// Classical evaluation weights as packed (midgame, endgame) scores.\n"
+        "//\n"
+        "// This file is regenerated by tools/tune.cpp; keep the layout\n"
+        "// (names, 8 values per row, A1 = index 0) when editing by hand.\n"
+        "// ============================================================\n\n"
+        "namespace chess::params {\n\n"
+        "constexpr Score S(int mg, int eg) { return make_score(mg, eg); }\n\n"
+        "// Material\n"
+        "inline constexpr Score Material[PIECE_TYPE_NB] = {\n    S(   0,   0),");
+    for (int pt = PAWN; pt <= QUEEN; ++pt)
+        std::fprintf(f, " %s,", score_string(w, W_MATERIAL + pt - 1).c_str());
+    std::fprintf(f, " S(   0,   0),\n};\n");
+
+    std::fprintf(f,
+        "\n// ============================================================\n"
+        "// Piece-Square Tables (from White's perspective, A1=index 0)\n"
+        "// ============================================================\n");
+    const char* names[PIECE_TYPE_NB] = {"", "Pawn", "Knight", "Bishop", "Rook", "Queen", "King"};
+    for (int pt = PAWN; pt <= KING; ++pt) {
+        std::fprintf(f, "\n");
+        write_table(f, (std::string(names[pt]) + "PST").c_str(), w, W_PSQT + (pt - 1) * 64);
+    }
+
+    std::fprintf(f, "\n// Pawn structure\n");
+    write_term(f, "Doubled", w, W_DOUBLED);
+    write_term(f, "Isolated", w, W_ISOLATED);
+    write_term(f, "Backward", w, W_BACKWARD);
+    write_term(f, "Connected", w, W_CONNECTED);
+    std::fprintf(f, "\n// Passed pawns, by relative rank\n"
+                    "inline constexpr Score PassedPawn[RANK_NB] = {\n   ");
+    for (int r = 0; r < RANK_NB; ++r)
+        std::fprintf(f, " %s,", score_string(w, W_PASSED + r).c_str());
+    std::fprintf(f, "\n};\n");
+    std::fprintf(f, "\n// Mobility, per attacked square not occupied by own pieces\n");
+    write_term(f, "Mobility", w, W_MOBILITY);
+    std::fprintf(f, "\n// King safety, per enemy attack on the king zone\n");
+    write_term(f, "KingAttack", w, W_KING_ATTACK);
+    std::fprintf(f, "\n// Bishop pair\n");
+    write_term(f, "BishopPair", w, W_BISHOP_PAIR);
+    std::fprintf(f, "\n} // namespace chess::params\n");
+
+    std::fclose(f);
+    return true;
+}
+
+// ============================================================
+// Main
+// ============================================================
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: tune <data> <out.hpp> [--iterations N] [--lr X] [--threads N] [--k X]" << std::endl;
+        return 1;
+    }
+
+    std::string data_path = argv[1], out_path = argv[2];
+    int iterations = 2000;
+    double lr = 1.0, k = 0.0;
+    int threads = std::max(1, int(std::thread::hardware_concurrency()));
+    for (int a = 3; a + 1 < argc; a += 2) {
+        std::string key = argv[a], v = argv[a + 1];
+        if (key == "--iterations") iterations = std::stoi(v);
+        else if (key == "--lr") lr = std::stod(v);
+        else if (key == "--threads") threads = std::max(1, std::stoi(v));
+        else if (key == "--k") k = std::stod(v);
+    }
+
+    init_attacks();
+    init_bitbases();
+
+    // Trace every position once
+    Dataset data;
+    std::ifstream in(data_path);
+    if (!in) {
+        std::cerr << "failed to open " << data_path << std::endl;
+        return 1;
+    }
+    std::string line, fen;
+    float result;
+    Board board;
+    while (std::getline(in, line)) {
+        if (!parse_line(line, fen, result)) continue;
+        board.set_fen(fen);
+        trace_position(board, result, data);
+    }
+    if (data.positions.empty()) {
+        std::cerr << "no usable positions in " << data_path << std::endl;
+        return 1;
+    }
+    std::cout << "traced " << data.positions.size() << " positions, "
+              << data.coefs.size() << " coefficients, " << threads << " threads" << std::endl;
+
+    Weights w = initial_weights();
+    if (k <= 0.0) k = compute_k(data, w, threads);
+    std::cout << "K = " << k << ", initial error " << total_error(data, w, k, threads) << std::endl;
+
+    // Adam over the full data set
+    Weights m{}, v{};
+    std::vector<Weights> grads(threads);
+    const double beta1 = 0.9, beta2 = 0.999, eps = 1e-8;
+    const double kscale = k * std::log(10.0) / 400.0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int it = 1; it <= iterations; ++it) {
+        parallel_for(threads, [&](int t) {
+            Weights& g = grads[t];
+            g = Weights{};
+            for (size_t i = t; i < data.positions.size(); i += threads) {
+                const TunePosition& p = data.positions[i];
+                double s = sigmoid(k, linear_eval(data, p, w));
+                double d = (s - p.result) * s * (1.0 - s) * kscale;
+                double dmg = d * p.phase / TOTAL_PHASE;
+                double deg = d * (TOTAL_PHASE - p.phase) / TOTAL_PHASE * p.scale / SCALE_FACTOR_NORMAL;
+                for (uint32_t j = p.begin; j < p.end; ++j) {
+                    g.mg[data.coefs[j].index] += dmg * data.coefs[j].value;
+                    g.eg[data.coefs[j].index] += deg * data.coefs[j].value;
+                }
+            }
+        });
+
+        double c1 = 1.0 - std::pow(beta1, it), c2 = 1.0 - std::pow(beta2, it);
+        for (int i = 0; i < W_COUNT; ++i) {
+            double gm = 0.0, ge = 0.0;
+            for (auto& g : grads) { gm += g.mg[i]; ge += g.eg[i]; }
+            gm *= 2.0 / double(data.positions.size());
+            ge *= 2.0 / double(data.positions.size());
+
+            m.mg[i] = beta1 * m.mg[i] + (1 - beta1) * gm;
+            v.mg[i] = beta2 * v.mg[i] + (1 - beta2) * gm * gm;
+            w.mg[i] -= lr * (m.mg[i] / c1) / (std::sqrt(v.mg[i] / c2) + eps);
+            m.eg[i] = beta1 * m.eg[i] + (1 - beta1) * ge;
+            v.eg[i] = beta2 * v.eg[i] + (1 - beta2) * ge * ge;
+            w.eg[i] -= lr * (m.eg[i] / c1) / (std::sqrt(v.eg[i] / c2) + eps);
+        }
+
+        if (it % 100 == 0 || it == iterations) {
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "iteration " << it << " error " << total_error(data, w, k, threads)
+                      << " (" << secs << " s)" << std::endl;
+            write_params(out_path, w);
+        }
+    }
+
+    if (!write_params(out_path, w)) {
+        std::cerr << "failed to write " << out_path << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << out_path << std::endl;
+    return 0;
+}